@@ -1,36 +1,96 @@
 #pragma once
 
+#include <cassert>
+#include <cstddef>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include "instrumentation.h"
 
-template <typename T>
+struct UninitializedTag {
+    explicit UninitializedTag() = default;
+};
+
+inline constexpr UninitializedTag uninitialized{};
+
+template <typename T, typename Allocator = std::allocator<T>>
 class ArrayPtr {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>);
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>);
+
+    static constexpr bool kDefaultAllocator = std::is_same_v<Allocator, std::allocator<T>>;
+
 public:
+    using allocator_type = Allocator;
+
     ArrayPtr() = default;
 
-    explicit ArrayPtr(T* raw_ptr) noexcept : ptr_(raw_ptr) {
+    explicit ArrayPtr(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
     }
 
-    explicit ArrayPtr(size_t size)
+    explicit ArrayPtr(T* raw_ptr) noexcept requires kDefaultAllocator
+        : ptr_(raw_ptr) {
+    }
+
+    explicit ArrayPtr(size_t size) requires kDefaultAllocator
         : ptr_(size > 0 ? new T[size] : nullptr) {
     }
 
-    ArrayPtr(ArrayPtr&& other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {
+    // Allocates raw storage for size objects through the allocator without constructing them.
+    // The owner is responsible for constructing and destroying elements.
+    ArrayPtr(size_t size, UninitializedTag, const Allocator& alloc = Allocator())
+        : alloc_(alloc) {
+        if (size > 0) {
+            ptr_ = AllocTraits::allocate(alloc_, size);
+            size_ = size;
+            VectorEvents<T>::Allocation(size);
+        }
+        raw_ = true;
+    }
+
+    // Takes back raw storage for size objects that an ArrayPtr allocated from an equal
+    // allocator and handed out through Release().
+    ArrayPtr(T* storage, size_t size, UninitializedTag, const Allocator& alloc = Allocator()) noexcept
+        : ptr_(storage)
+        , size_(storage != nullptr ? size : 0)
+        , raw_(true)
+        , alloc_(alloc) {
+    }
+
+    ArrayPtr(ArrayPtr&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , raw_(std::exchange(other.raw_, false))
+        , alloc_(other.alloc_) {
     }
 
     ArrayPtr(const ArrayPtr&) = delete;
 
     ~ArrayPtr() {
-        delete[] ptr_;
+        Free();
     }
 
     explicit operator bool() const noexcept {
         return ptr_ != nullptr;
     }
 
+    // Takes over the storage of other. The allocator is taken along when it is assignable,
+    // otherwise both allocators must compare equal.
     ArrayPtr& operator=(ArrayPtr&& other) noexcept {
         if (this != &other) {
-            swap(other);
+            Free();
+            if constexpr (std::is_move_assignable_v<Allocator>) {
+                alloc_ = std::move(other.alloc_);
+            } else {
+                assert(alloc_ == other.alloc_);
+            }
+            ptr_ = std::exchange(other.ptr_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            raw_ = std::exchange(other.raw_, false);
         }
         return *this;
     }
@@ -65,14 +125,57 @@ public:
         return ptr_;
     }
 
+    // Number of objects the raw storage has room for
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsRaw() const noexcept {
+        return raw_;
+    }
+
+    Allocator& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
     T* Release() noexcept {
+        size_ = 0;
+        raw_ = false;
         return std::exchange(ptr_, nullptr);
     }
 
+    // Allocators are exchanged only when they propagate on swap, otherwise they must compare equal.
     void swap(ArrayPtr& other) noexcept {
         std::swap(ptr_, other.ptr_);
+        std::swap(size_, other.size_);
+        std::swap(raw_, other.raw_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+    }
+
+private:
+    void Free() noexcept {
+        if (raw_) {
+            if (ptr_ != nullptr) {
+                AllocTraits::deallocate(alloc_, ptr_, size_);
+                VectorEvents<T>::Deallocation();
+            }
+        } else if constexpr (kDefaultAllocator) {
+            delete[] ptr_;
+        }
     }
 
 private:
     T* ptr_ = nullptr;
+    size_t size_ = 0;
+    bool raw_ = false;
+    [[no_unique_address]] Allocator alloc_;
 };
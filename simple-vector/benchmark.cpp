@@ -0,0 +1,480 @@
+#include "simple_vector.h"
+#include "vector_hash.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+size_t allocation_count = 0;
+size_t allocated_bytes = 0;
+
+void* CountedAllocate(size_t size, size_t alignment) {
+    ++allocation_count;
+    allocated_bytes += size;
+    void* ptr = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+        ? aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+        : malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return CountedAllocate(size, 0);
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocate(size, 0);
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, align_val_t alignment) {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t, align_val_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, align_val_t) noexcept {
+    free(ptr);
+}
+
+namespace {
+
+template <typename T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class X {
+public:
+    X()
+        : X(5) {
+    }
+    X(size_t num)
+        : x_(num) {
+    }
+    X(const X& other) = delete;
+    X& operator=(const X& other) = delete;
+    X(X&& other) noexcept {
+        x_ = exchange(other.x_, 0);
+    }
+    X& operator=(X&& other) noexcept {
+        x_ = exchange(other.x_, 0);
+        return *this;
+    }
+    size_t GetX() const {
+        return x_;
+    }
+    auto operator<=>(const X&) const = default;
+
+private:
+    size_t x_;
+};
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (is_same_v<T, string>) {
+        return "value number " + to_string(i) + " long enough to allocate";
+    } else {
+        return T(i);
+    }
+}
+
+string_view TypeName(const int*) {
+    return "int";
+}
+
+string_view TypeName(const string*) {
+    return "string";
+}
+
+string_view TypeName(const X*) {
+    return "X";
+}
+
+struct SimpleVectorApi {
+    template <typename T>
+    using Vector = SimpleVector<T>;
+
+    static constexpr string_view kName = "SimpleVector";
+
+    template <typename T, typename U>
+    static void PushBack(Vector<T>& v, U&& value) {
+        v.PushBack(forward<U>(value));
+    }
+    template <typename T, typename U>
+    static void Insert(Vector<T>& v, size_t index, U&& value) {
+        v.Insert(v.begin() + index, forward<U>(value));
+    }
+    template <typename T>
+    static void Erase(Vector<T>& v, size_t index) {
+        v.Erase(v.begin() + index);
+    }
+    template <typename T>
+    static void UnorderedErase(Vector<T>& v, size_t index) {
+        v.SwapRemove(index);
+    }
+    template <typename T>
+    static void Reserve(Vector<T>& v, size_t capacity) {
+        v.Reserve(capacity);
+    }
+    template <typename T, typename U>
+    static void PushBackUnchecked(Vector<T>& v, U&& value) {
+        v.PushBackUnchecked(forward<U>(value));
+    }
+    template <typename T>
+    static T* AppendUninitialized(Vector<T>& v, size_t count) {
+        return v.AppendUninitialized(count);
+    }
+    template <typename T>
+    static size_t Hash(const Vector<T>& v) {
+        return hash<Vector<T>>()(v);
+    }
+    template <typename T>
+    static size_t Size(const Vector<T>& v) {
+        return v.GetSize();
+    }
+};
+
+struct StdVectorApi {
+    template <typename T>
+    using Vector = vector<T>;
+
+    static constexpr string_view kName = "std::vector";
+
+    template <typename T, typename U>
+    static void PushBack(Vector<T>& v, U&& value) {
+        v.push_back(forward<U>(value));
+    }
+    template <typename T, typename U>
+    static void Insert(Vector<T>& v, size_t index, U&& value) {
+        v.insert(v.begin() + index, forward<U>(value));
+    }
+    template <typename T>
+    static void Erase(Vector<T>& v, size_t index) {
+        v.erase(v.begin() + index);
+    }
+    template <typename T>
+    static void UnorderedErase(Vector<T>& v, size_t index) {
+        if (index + 1 != v.size()) {
+            v[index] = move(v.back());
+        }
+        v.pop_back();
+    }
+    template <typename T>
+    static void Reserve(Vector<T>& v, size_t capacity) {
+        v.reserve(capacity);
+    }
+    template <typename T, typename U>
+    static void PushBackUnchecked(Vector<T>& v, U&& value) {
+        v.push_back(forward<U>(value));
+    }
+    // std::vector has no uninitialized growth, resize value-initializes
+    template <typename T>
+    static T* AppendUninitialized(Vector<T>& v, size_t count) {
+        v.resize(v.size() + count);
+        return v.data() + v.size() - count;
+    }
+    // std::vector has no std::hash, combine the element hashes the usual way
+    template <typename T>
+    static size_t Hash(const Vector<T>& v) {
+        size_t seed = v.size();
+        for (const T& item : v) {
+            seed ^= hash<T>()(item) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+    template <typename T>
+    static size_t Size(const Vector<T>& v) {
+        return v.size();
+    }
+};
+
+struct Measurement {
+    double ns_per_op = 0;
+    double allocations_per_iteration = 0;
+    double bytes_per_iteration = 0;
+};
+
+// Runs body until it has been timed for at least min_time, or the whole run including
+// setup exceeds max_time. body performs ops operations per call; setup runs before
+// every call and is excluded from both timing and allocation counts.
+template <typename Setup, typename Body>
+Measurement Measure(size_t ops, Setup setup, Body body) {
+    using Clock = chrono::steady_clock;
+    constexpr auto min_time = chrono::milliseconds(50);
+    constexpr auto max_time = chrono::milliseconds(500);
+
+    const auto run_start = Clock::now();
+    chrono::nanoseconds elapsed{0};
+    size_t iterations = 0;
+    size_t allocations = 0;
+    size_t bytes = 0;
+    while (iterations < 3 || (elapsed < min_time && Clock::now() - run_start < max_time)) {
+        auto state = setup();
+        const size_t allocations_before = allocation_count;
+        const size_t bytes_before = allocated_bytes;
+        const auto start = Clock::now();
+        body(state);
+        elapsed += Clock::now() - start;
+        allocations += allocation_count - allocations_before;
+        bytes += allocated_bytes - bytes_before;
+        ++iterations;
+        DoNotOptimize(state);
+    }
+    Measurement result;
+    result.ns_per_op = static_cast<double>(elapsed.count()) / (static_cast<double>(iterations) * ops);
+    result.allocations_per_iteration = static_cast<double>(allocations) / iterations;
+    result.bytes_per_iteration = static_cast<double>(bytes) / iterations;
+    return result;
+}
+
+string_view filter;
+
+template <typename Api, typename T>
+void Report(string_view benchmark, size_t size, const Measurement& m) {
+    printf("%-22s %-7s %8zu  %-13s %10.2f ns/op %10.1f allocs %14.0f bytes\n",
+           benchmark.data(), TypeName(static_cast<const T*>(nullptr)).data(), size, Api::kName.data(),
+           m.ns_per_op, m.allocations_per_iteration, m.bytes_per_iteration);
+}
+
+template <typename Api, typename T>
+typename Api::template Vector<T> Filled(size_t size) {
+    typename Api::template Vector<T> v;
+    for (size_t i = 0; i < size; ++i) {
+        Api::PushBack(v, MakeValue<T>(i));
+    }
+    return v;
+}
+
+template <typename Api, typename T>
+void BenchPushBack(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    auto m = Measure(size, [] { return Vector(); }, [size](Vector& v) {
+        for (size_t i = 0; i < size; ++i) {
+            Api::PushBack(v, MakeValue<T>(i));
+        }
+    });
+    Report<Api, T>("PushBack", size, m);
+}
+
+template <typename Api, typename T>
+void BenchReserveFill(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    auto m = Measure(size, [] { return Vector(); }, [size](Vector& v) {
+        Api::Reserve(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            Api::PushBack(v, MakeValue<T>(i));
+        }
+    });
+    Report<Api, T>("Reserve+PushBack", size, m);
+}
+
+template <typename Api, typename T>
+void BenchReserveFillUnchecked(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    auto m = Measure(size, [] { return Vector(); }, [size](Vector& v) {
+        Api::Reserve(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            Api::PushBackUnchecked(v, MakeValue<T>(i));
+        }
+    });
+    Report<Api, T>("Reserve+Unchecked", size, m);
+}
+
+template <typename Api, typename T>
+void BenchAppendUninitialized(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    auto m = Measure(size, [] { return Vector(); }, [size](Vector& v) {
+        T* data = Api::AppendUninitialized(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = MakeValue<T>(i);
+        }
+    });
+    Report<Api, T>("AppendUninitialized", size, m);
+}
+
+// Inserts and then erases batch elements at the given relative position of a vector of size elements
+template <typename Api, typename T>
+void BenchInsertErase(string_view name, size_t size, double position) {
+    using Vector = typename Api::template Vector<T>;
+    const size_t batch = 64;
+    auto m = Measure(batch * 2, [size] { return Filled<Api, T>(size); }, [&](Vector& v) {
+        for (size_t i = 0; i < batch; ++i) {
+            Api::Insert(v, static_cast<size_t>(Api::Size(v) * position), MakeValue<T>(i));
+        }
+        for (size_t i = 0; i < batch; ++i) {
+            const size_t index = static_cast<size_t>(Api::Size(v) * position);
+            Api::Erase(v, index < Api::Size(v) ? index : Api::Size(v) - 1);
+        }
+    });
+    Report<Api, T>(name, size, m);
+}
+
+// Erases batch elements from the front without keeping the order
+template <typename Api, typename T>
+void BenchUnorderedErase(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    const size_t batch = min<size_t>(64, size);
+    auto m = Measure(batch, [size] { return Filled<Api, T>(size); }, [batch](Vector& v) {
+        for (size_t i = 0; i < batch; ++i) {
+            Api::UnorderedErase(v, 0);
+        }
+    });
+    Report<Api, T>("UnorderedErase/front", size, m);
+}
+
+template <typename Api, typename T>
+void BenchCopyAssign(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    const Vector source = Filled<Api, T>(size);
+    auto m = Measure(1, [] { return Vector(); }, [&source](Vector& v) {
+        v = source;
+    });
+    Report<Api, T>("CopyAssign", size, m);
+}
+
+template <typename Api, typename T>
+void BenchMoveAssign(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    struct State {
+        Vector source;
+        Vector target;
+    };
+    auto m = Measure(1, [size] { return State{Filled<Api, T>(size), Vector()}; }, [](State& state) {
+        state.target = move(state.source);
+    });
+    Report<Api, T>("MoveAssign", size, m);
+}
+
+template <typename Api, typename T>
+void BenchCompare(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    struct State {
+        Vector lhs;
+        Vector rhs;
+    };
+    auto m = Measure(size, [size] { return State{Filled<Api, T>(size), Filled<Api, T>(size)}; },
+                     [](State& state) {
+                         bool equal = state.lhs == state.rhs;
+                         bool less = state.lhs < state.rhs;
+                         DoNotOptimize(equal);
+                         DoNotOptimize(less);
+                     });
+    Report<Api, T>("Compare", size, m);
+}
+
+template <typename Api, typename T>
+void BenchHash(size_t size) {
+    using Vector = typename Api::template Vector<T>;
+    auto m = Measure(size, [size] { return Filled<Api, T>(size); }, [](Vector& v) {
+        DoNotOptimize(Api::Hash(v));
+    });
+    Report<Api, T>("Hash", size, m);
+}
+
+template <typename Api, typename T>
+void RunSuite(size_t size) {
+    auto enabled = [](string_view name) {
+        return filter.empty() || name.find(filter) != string_view::npos;
+    };
+    if (enabled("PushBack")) {
+        BenchPushBack<Api, T>(size);
+    }
+    if (enabled("Reserve")) {
+        BenchReserveFill<Api, T>(size);
+        BenchReserveFillUnchecked<Api, T>(size);
+    }
+    if constexpr (is_trivial_v<T>) {
+        if (enabled("AppendUninitialized")) {
+            BenchAppendUninitialized<Api, T>(size);
+        }
+    }
+    if (enabled("Insert")) {
+        BenchInsertErase<Api, T>("InsertErase/front", size, 0.0);
+        BenchInsertErase<Api, T>("InsertErase/middle", size, 0.5);
+        BenchInsertErase<Api, T>("InsertErase/back", size, 1.0);
+    }
+    if (enabled("UnorderedErase")) {
+        BenchUnorderedErase<Api, T>(size);
+    }
+    if constexpr (is_copy_constructible_v<T>) {
+        if (enabled("CopyAssign")) {
+            BenchCopyAssign<Api, T>(size);
+        }
+    }
+    if (enabled("MoveAssign")) {
+        BenchMoveAssign<Api, T>(size);
+    }
+    if (enabled("Compare")) {
+        BenchCompare<Api, T>(size);
+    }
+    if constexpr (vector_hash::Hashable<T>) {
+        if (enabled("Hash")) {
+            BenchHash<Api, T>(size);
+        }
+    }
+}
+
+template <typename T>
+void RunForType(const vector<size_t>& sizes) {
+    for (size_t size : sizes) {
+        RunSuite<SimpleVectorApi, T>(size);
+        RunSuite<StdVectorApi, T>(size);
+    }
+}
+
+}  // namespace
+
+// Usage: benchmark [name filter]
+// Build with optimizations, e.g. g++ -std=c++20 -O2 -DNDEBUG benchmark.cpp
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        filter = argv[1];
+    }
+    const vector<size_t> sizes{16, 1024, 65536};
+    RunForType<int>(sizes);
+    RunForType<string>(sizes);
+    RunForType<X>(sizes);
+    return 0;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include "simple_vector.h"
+
+struct BufferPoolLimits {
+    // Free blocks a thread keeps for itself before handing them to the global list
+    size_t thread_cache_bytes = 4 << 20;
+    // Free blocks kept in the global overflow list before they are released
+    size_t global_cache_bytes = 64 << 20;
+};
+
+struct BufferPoolStats {
+    // Hits of the calling thread and of the threads that have exited or called Trim
+    uint64_t thread_hits = 0;
+    uint64_t global_hits = 0;
+    uint64_t system_allocations = 0;
+    uint64_t system_deallocations = 0;
+};
+
+// Recycles buffers of power-of-two size classes. Freed blocks go to a cache of the
+// freeing thread first, then to a mutex-protected global overflow list, and are only
+// released to operator delete once both are at their limits. Allocation takes from
+// the same places in the same order, so the hot path touches no shared state.
+class BufferPool {
+public:
+    static constexpr size_t kMinBlockShift = 6;
+    // Larger blocks always go straight to operator new/delete
+    static constexpr size_t kMaxBlockShift = 20;
+    // Pooled blocks are cache-line aligned; types needing more alignment are not pooled
+    static constexpr size_t kBlockAlignment = size_t{1} << kMinBlockShift;
+
+    static BufferPool& Instance() {
+        // never destroyed: thread caches hand their buffers back on thread exit, which may
+        // come during static destruction, after a function-local static would be gone
+        static BufferPool& pool = *new BufferPool;
+        return pool;
+    }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool() {
+        ReleaseGlobal();
+    }
+
+    // Limits apply to blocks freed from now on
+    void SetLimits(const BufferPoolLimits& limits) noexcept {
+        thread_cache_bytes_.store(limits.thread_cache_bytes, std::memory_order_relaxed);
+        global_cache_bytes_.store(limits.global_cache_bytes, std::memory_order_relaxed);
+    }
+
+    BufferPoolLimits GetLimits() const noexcept {
+        BufferPoolLimits limits;
+        limits.thread_cache_bytes = thread_cache_bytes_.load(std::memory_order_relaxed);
+        limits.global_cache_bytes = global_cache_bytes_.load(std::memory_order_relaxed);
+        return limits;
+    }
+
+    BufferPoolStats GetStats() const noexcept {
+        BufferPoolStats stats;
+        stats.thread_hits = thread_hits_.load(std::memory_order_relaxed) + LocalCache().hits;
+        stats.global_hits = global_hits_.load(std::memory_order_relaxed);
+        stats.system_allocations = system_allocations_.load(std::memory_order_relaxed);
+        stats.system_deallocations = system_deallocations_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    void* Allocate(size_t bytes, size_t alignment) {
+        if (!IsPooled(bytes, alignment)) {
+            return SystemAllocate(bytes, alignment);
+        }
+        const size_t size_class = SizeClass(bytes);
+        ThreadCache& cache = LocalCache();
+        if (FreeBlock* block = cache.lists[size_class]) {
+            cache.lists[size_class] = block->next;
+            cache.bytes -= ClassBytes(size_class);
+            ++cache.hits;
+            return block;
+        }
+        {
+            GlobalList& list = global_[size_class];
+            std::lock_guard guard(list.mutex);
+            if (FreeBlock* block = list.head) {
+                list.head = block->next;
+                global_bytes_.fetch_sub(ClassBytes(size_class), std::memory_order_relaxed);
+                global_hits_.fetch_add(1, std::memory_order_relaxed);
+                return block;
+            }
+        }
+        return SystemAllocate(ClassBytes(size_class), kBlockAlignment);
+    }
+
+    // bytes and alignment must be the ones the block was allocated with
+    void Deallocate(void* ptr, size_t bytes, size_t alignment) noexcept {
+        if (!IsPooled(bytes, alignment)) {
+            SystemDeallocate(ptr, alignment);
+            return;
+        }
+        const size_t size_class = SizeClass(bytes);
+        const size_t block_bytes = ClassBytes(size_class);
+        auto* block = static_cast<FreeBlock*>(ptr);
+        ThreadCache& cache = LocalCache();
+        if (cache.bytes + block_bytes <= thread_cache_bytes_.load(std::memory_order_relaxed)) {
+            block->next = cache.lists[size_class];
+            cache.lists[size_class] = block;
+            cache.bytes += block_bytes;
+            return;
+        }
+        PushGlobal(block, size_class);
+    }
+
+    // Releases the global overflow list and the free blocks cached by the calling thread
+    void Trim() noexcept {
+        LocalCache().Flush(*this, false);
+        ReleaseGlobal();
+    }
+
+private:
+    static constexpr size_t kClassCount = kMaxBlockShift - kMinBlockShift + 1;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct GlobalList {
+        std::mutex mutex;
+        FreeBlock* head = nullptr;
+    };
+
+    void ReleaseGlobal() noexcept {
+        for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+            GlobalList& list = global_[size_class];
+            std::lock_guard guard(list.mutex);
+            while (FreeBlock* block = list.head) {
+                list.head = block->next;
+                global_bytes_.fetch_sub(ClassBytes(size_class), std::memory_order_relaxed);
+                SystemDeallocate(block, kBlockAlignment);
+            }
+        }
+    }
+
+    // Hands its blocks to the global list when the thread exits. Hits are counted here
+    // and added to the pool's total on Flush, keeping the shared counter off the hot path.
+    struct ThreadCache {
+        FreeBlock* lists[kClassCount] = {};
+        size_t bytes = 0;
+        uint64_t hits = 0;
+
+        ~ThreadCache() {
+            Flush(Instance(), true);
+        }
+
+        void Flush(BufferPool& pool, bool keep_globally) noexcept {
+            for (size_t size_class = 0; size_class < kClassCount; ++size_class) {
+                while (FreeBlock* block = lists[size_class]) {
+                    lists[size_class] = block->next;
+                    if (keep_globally) {
+                        pool.PushGlobal(block, size_class);
+                    } else {
+                        pool.SystemDeallocate(block, kBlockAlignment);
+                    }
+                }
+            }
+            bytes = 0;
+            pool.thread_hits_.fetch_add(hits, std::memory_order_relaxed);
+            hits = 0;
+        }
+    };
+
+    BufferPool() = default;
+
+    static size_t SizeClass(size_t bytes) noexcept {
+        return bytes <= kBlockAlignment ? 0 : std::bit_width(bytes - 1) - kMinBlockShift;
+    }
+
+    static size_t ClassBytes(size_t size_class) noexcept {
+        return size_t{1} << (size_class + kMinBlockShift);
+    }
+
+    static bool IsPooled(size_t bytes, size_t alignment) noexcept {
+        return alignment <= kBlockAlignment && bytes <= (size_t{1} << kMaxBlockShift);
+    }
+
+    static ThreadCache& LocalCache() noexcept {
+        // thread_local objects are destroyed before statics, so the pool outlives the main thread's cache
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    void PushGlobal(FreeBlock* block, size_t size_class) noexcept {
+        const size_t block_bytes = ClassBytes(size_class);
+        if (global_bytes_.fetch_add(block_bytes, std::memory_order_relaxed) + block_bytes
+            <= global_cache_bytes_.load(std::memory_order_relaxed)) {
+            GlobalList& list = global_[size_class];
+            std::lock_guard guard(list.mutex);
+            block->next = list.head;
+            list.head = block;
+            return;
+        }
+        global_bytes_.fetch_sub(block_bytes, std::memory_order_relaxed);
+        SystemDeallocate(block, kBlockAlignment);
+    }
+
+    void* SystemAllocate(size_t bytes, size_t alignment) {
+        system_allocations_.fetch_add(1, std::memory_order_relaxed);
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return ::operator new(bytes, std::align_val_t(alignment));
+        }
+        return ::operator new(bytes);
+    }
+
+    void SystemDeallocate(void* ptr, size_t alignment) noexcept {
+        system_deallocations_.fetch_add(1, std::memory_order_relaxed);
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            ::operator delete(ptr, std::align_val_t(alignment));
+        } else {
+            ::operator delete(ptr);
+        }
+    }
+
+    std::atomic<size_t> thread_cache_bytes_{BufferPoolLimits().thread_cache_bytes};
+    std::atomic<size_t> global_cache_bytes_{BufferPoolLimits().global_cache_bytes};
+
+    GlobalList global_[kClassCount];
+    std::atomic<size_t> global_bytes_{0};
+
+    std::atomic<uint64_t> thread_hits_{0};
+    std::atomic<uint64_t> global_hits_{0};
+    std::atomic<uint64_t> system_allocations_{0};
+    std::atomic<uint64_t> system_deallocations_{0};
+};
+
+// Stateless allocator drawing from BufferPool::Instance()
+template <typename T>
+class PooledAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    PooledAllocator() noexcept = default;
+
+    template <typename U>
+    PooledAllocator(const PooledAllocator<U>&) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(BufferPool::Instance().Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        BufferPool::Instance().Deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PooledAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+template <typename Type, typename GrowthPolicy = DoublingGrowth>
+using PooledSimpleVector = SimpleVector<Type, PooledAllocator<Type>, GrowthPolicy>;
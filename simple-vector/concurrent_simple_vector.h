@@ -0,0 +1,205 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "array_ptr.h"
+#include "element_ops.h"
+#include "simple_vector.h"
+
+// Append-only vector that many threads may push into at once without locking.
+// Elements live in segments that never move, segment k holding first_segment << k
+// elements, so references returned by PushBack/EmplaceBack stay valid until Freeze.
+//
+// An element becomes visible to other threads the usual way, i.e. after they synchronize
+// with the pushing thread; GetSize counts claimed slots, including ones still being built.
+// Reads, Freeze and destruction must not race with pushes. Allocator must tolerate
+// concurrent allocate and construct calls, as std::allocator does.
+template <typename Type, typename Allocator = std::allocator<Type>>
+class ConcurrentSimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using allocator_type = Allocator;
+
+    static constexpr size_t kMinFirstSegment = 32;
+
+    // Freeze is free of copies while the size stays within the first segment,
+    // so a good capacity_hint is the expected final size.
+    explicit ConcurrentSimpleVector(size_t capacity_hint = kMinFirstSegment, const Allocator& alloc = Allocator())
+        : first_shift_(std::countr_zero(std::bit_ceil(std::max(capacity_hint, kMinFirstSegment))))
+        , alloc_(alloc) {
+    }
+
+    ConcurrentSimpleVector(const ConcurrentSimpleVector&) = delete;
+    ConcurrentSimpleVector& operator=(const ConcurrentSimpleVector&) = delete;
+
+    ~ConcurrentSimpleVector() {
+        Clear();
+    }
+
+    Type& PushBack(const Type& item) {
+        return EmplaceBack(item);
+    }
+
+    Type& PushBack(Type&& item) {
+        return EmplaceBack(std::move(item));
+    }
+
+    // A slot is claimed only once nothing can throw any more: types that may throw while
+    // being constructed from args are built on the stack first and moved in, which is
+    // why they need a nothrow move constructor.
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<Type, Args&&...>) {
+            Type* slot = ClaimSlot();
+            AllocTraits::construct(alloc_, slot, std::forward<Args>(args)...);
+            return *slot;
+        } else {
+            static_assert(std::is_nothrow_move_constructible_v<Type>,
+                          "elements with a throwing constructor need a nothrow move constructor");
+            Type value(std::forward<Args>(args)...);
+            Type* slot = ClaimSlot();
+            AllocTraits::construct(alloc_, slot, std::move(value));
+            return *slot;
+        }
+    }
+
+    size_t GetSize() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        const auto [segment, offset] = Locate(index);
+        return segments_[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        const auto [segment, offset] = Locate(index);
+        return segments_[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Moves the elements into a contiguous SimpleVector and leaves this vector empty.
+    // The first segment is adopted as is while every element fits into it; otherwise
+    // the elements are relocated into a buffer of exactly the right size.
+    template <typename GrowthPolicy = DoublingGrowth>
+    SimpleVector<Type, Allocator, GrowthPolicy> Freeze() {
+        const size_t size = size_.load(std::memory_order_acquire);
+        if (size <= SegmentSize(0)) {
+            ArrayPtr<Type, Allocator> storage(segments_[0].exchange(nullptr, std::memory_order_acq_rel),
+                                              SegmentSize(0), uninitialized, alloc_);
+            FreeSegments();
+            size_.store(0, std::memory_order_release);
+            return SimpleVector<Type, Allocator, GrowthPolicy>(std::move(storage), size);
+        }
+
+        ArrayPtr<Type, Allocator> storage(size, uninitialized, alloc_);
+        ElementOps<Type, Allocator> ops(alloc_);
+        size_t done = 0;
+        try {
+            ForEachSegment(size, [&](Type* first, Type* last) {
+                ops.UninitializedTransfer(first, last, storage.GetRawPtr() + done);
+                done += last - first;
+            });
+        } catch (...) {
+            ops.Destroy(storage.GetRawPtr(), storage.GetRawPtr() + done);
+            throw;
+        }
+        ForEachSegment(size, [&](Type* first, Type* last) {
+            ops.DestroyTransferred(first, last);
+        });
+        FreeSegments();
+        size_.store(0, std::memory_order_release);
+        return SimpleVector<Type, Allocator, GrowthPolicy>(std::move(storage), size);
+    }
+
+    void Clear() noexcept {
+        ElementOps<Type, Allocator> ops(alloc_);
+        ForEachSegment(size_.load(std::memory_order_acquire), [&](Type* first, Type* last) {
+            ops.Destroy(first, last);
+        });
+        FreeSegments();
+        size_.store(0, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t kMaxSegments = 64;
+
+    struct Location {
+        size_t segment;
+        size_t offset;
+    };
+
+    size_t SegmentSize(size_t segment) const noexcept {
+        return size_t{1} << (first_shift_ + segment);
+    }
+
+    // Segment k starts at first_segment * (2^k - 1)
+    Location Locate(size_t index) const noexcept {
+        const size_t segment = std::bit_width((index >> first_shift_) + 1) - 1;
+        return {segment, index - (((size_t{1} << segment) - 1) << first_shift_)};
+    }
+
+    // Claims the next index once its segment exists, so a failed allocation claims nothing
+    Type* ClaimSlot() {
+        size_t index = size_.load(std::memory_order_relaxed);
+        while (true) {
+            const auto [segment, offset] = Locate(index);
+            Type* storage = SegmentStorage(segment);
+            if (size_.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                return storage + offset;
+            }
+        }
+    }
+
+    Type* SegmentStorage(size_t segment) {
+        Type* storage = segments_[segment].load(std::memory_order_acquire);
+        if (storage != nullptr) {
+            return storage;
+        }
+        ArrayPtr<Type, Allocator> fresh(SegmentSize(segment), uninitialized, alloc_);
+        if (segments_[segment].compare_exchange_strong(storage, fresh.GetRawPtr(), std::memory_order_acq_rel)) {
+            return fresh.Release();
+        }
+        // another thread installed the segment first, ours is freed on return
+        return storage;
+    }
+
+    // Calls body(first, last) for the constructed part of every segment, in index order
+    template <typename Body>
+    void ForEachSegment(size_t size, Body body) {
+        size_t start = 0;
+        for (size_t segment = 0; start < size; ++segment) {
+            Type* storage = segments_[segment].load(std::memory_order_acquire);
+            const size_t count = std::min(SegmentSize(segment), size - start);
+            body(storage, storage + count);
+            start += count;
+        }
+    }
+
+    void FreeSegments() noexcept {
+        for (size_t segment = 0; segment < kMaxSegments - first_shift_; ++segment) {
+            ArrayPtr<Type, Allocator> storage(segments_[segment].exchange(nullptr, std::memory_order_acq_rel),
+                                              SegmentSize(segment), uninitialized, alloc_);
+        }
+    }
+
+    std::atomic<size_t> size_{0};
+    const size_t first_shift_;
+    std::atomic<Type*> segments_[kMaxSegments] = {};
+    [[no_unique_address]] Allocator alloc_;
+};
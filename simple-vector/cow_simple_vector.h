@@ -0,0 +1,315 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+#include "vector_hash.h"
+
+// SimpleVector whose copies share one reference-counted buffer until one of them is
+// modified. Copying and assignment are O(1) and the object is one pointer wide for
+// stateless allocators; the first mutating call on a shared buffer clones it.
+//
+// Like std::shared_ptr, different CowSimpleVector objects may be used from different
+// threads even when they share a buffer, but one object must not be used concurrently.
+// References and iterators from mutating accessors (non-const operator[], At, begin)
+// are only good until the vector is copied or hashed: write through them before sharing it.
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+class CowSimpleVector {
+    using Vector = SimpleVector<Type, Allocator, GrowthPolicy>;
+
+    struct Shared {
+        template <typename... Args>
+        explicit Shared(Args&&... args)
+            : items(std::forward<Args>(args)...) {
+        }
+
+        std::atomic<size_t> refs{1};
+        // kNoHash until Hash() is first called on the buffer
+        std::atomic<uint64_t> hash{kNoHash};
+        Vector items;
+    };
+
+    static constexpr uint64_t kNoHash = 0;
+
+    using SharedAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Shared>;
+    using SharedTraits = std::allocator_traits<SharedAllocator>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using allocator_type = Allocator;
+
+    CowSimpleVector() noexcept = default;
+
+    explicit CowSimpleVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    explicit CowSimpleVector(size_t size, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , shared_(Make(size, alloc)) {
+    }
+
+    CowSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , shared_(Make(size, value, alloc)) {
+    }
+
+    CowSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , shared_(Make(init, alloc)) {
+    }
+
+    // Takes over the buffer of items without copying the elements
+    explicit CowSimpleVector(Vector&& items)
+        : alloc_(items.GetAllocator())
+        , shared_(Make(std::move(items))) {
+    }
+
+    CowSimpleVector(const CowSimpleVector& other) noexcept
+        : alloc_(other.alloc_)
+        , shared_(other.shared_) {
+        if (shared_ != nullptr) {
+            shared_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowSimpleVector(CowSimpleVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , shared_(std::exchange(other.shared_, nullptr)) {
+    }
+
+    ~CowSimpleVector() {
+        Release();
+    }
+
+    CowSimpleVector& operator=(const CowSimpleVector& other) noexcept {
+        CowSimpleVector(other).swap(*this);
+        return *this;
+    }
+
+    CowSimpleVector& operator=(CowSimpleVector&& other) noexcept {
+        CowSimpleVector(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void swap(CowSimpleVector& other) noexcept {
+        using std::swap;
+        swap(alloc_, other.alloc_);
+        swap(shared_, other.shared_);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Number of CowSimpleVector objects sharing the buffer, 0 when there is none yet
+    size_t UseCount() const noexcept {
+        return shared_ != nullptr ? shared_->refs.load(std::memory_order_acquire) : 0;
+    }
+
+    bool IsShared() const noexcept {
+        return UseCount() > 1;
+    }
+
+    // Read-only access, never clones. Also see View().
+
+    size_t GetSize() const noexcept {
+        return shared_ != nullptr ? shared_->items.GetSize() : 0;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return shared_ != nullptr ? shared_->items.GetCapacity() : 0;
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return shared_->items[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Index out of range");
+        }
+        return shared_->items[index];
+    }
+
+    ConstIterator begin() const noexcept {
+        return shared_ != nullptr ? shared_->items.cbegin() : nullptr;
+    }
+
+    ConstIterator end() const noexcept {
+        return shared_ != nullptr ? shared_->items.cend() : nullptr;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    SimpleVectorView<const Type> View() const noexcept {
+        return SimpleVectorView<const Type>(begin(), GetSize());
+    }
+
+    // Same value as vector_hash::Hash over the elements. Computed once per buffer and
+    // shared by all copies, which suits vectors used as hash keys; mutating access resets it.
+    uint64_t Hash() const requires vector_hash::Hashable<Type> {
+        if (shared_ == nullptr) {
+            return vector_hash::Hash<Type>(nullptr, 0);
+        }
+        uint64_t hash = shared_->hash.load(std::memory_order_relaxed);
+        if (hash == kNoHash) {
+            // a buffer whose hash is kNoHash is simply rehashed every time
+            hash = vector_hash::Hash(shared_->items.cbegin(), shared_->items.GetSize());
+            shared_->hash.store(hash, std::memory_order_relaxed);
+        }
+        return hash;
+    }
+
+    // Mutating access, clones a shared buffer first
+
+    Type& operator[](size_t index) {
+        assert(index < GetSize());
+        return Mutable()[index];
+    }
+
+    Type& At(size_t index) {
+        return Mutable().At(index);
+    }
+
+    Iterator begin() {
+        return Mutable().begin();
+    }
+
+    Iterator end() {
+        return Mutable().end();
+    }
+
+    void PushBack(const Type& item) {
+        Mutable().PushBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        Mutable().PushBack(std::move(item));
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        const size_t offset = pos - cbegin();
+        Vector& items = Mutable();
+        return items.Insert(items.cbegin() + offset, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        const size_t offset = pos - cbegin();
+        Vector& items = Mutable();
+        return items.Insert(items.cbegin() + offset, std::move(value));
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        const size_t offset = pos - cbegin();
+        Vector& items = Mutable();
+        return items.Erase(items.cbegin() + offset);
+    }
+
+    void PopBack() {
+        assert(!IsEmpty());
+        Mutable().PopBack();
+    }
+
+    void Resize(size_t new_size) {
+        Mutable().Resize(new_size);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutable().Reserve(new_capacity);
+    }
+
+    // Drops this reference instead of clearing a buffer other copies may still use
+    void Clear() noexcept {
+        Release();
+    }
+
+    // Unique, modifiable access to the whole vector
+    Vector& Mutable() {
+        if (shared_ == nullptr) {
+            shared_ = Make(alloc_);
+        } else if (shared_->refs.load(std::memory_order_acquire) != 1) {
+            Shared* clone = Make(shared_->items);
+            Release();
+            shared_ = clone;
+        } else {
+            shared_->hash.store(kNoHash, std::memory_order_relaxed);
+        }
+        return shared_->items;
+    }
+
+private:
+    template <typename... Args>
+    Shared* Make(Args&&... args) {
+        SharedAllocator alloc(alloc_);
+        Shared* shared = SharedTraits::allocate(alloc, 1);
+        try {
+            SharedTraits::construct(alloc, shared, std::forward<Args>(args)...);
+        } catch (...) {
+            SharedTraits::deallocate(alloc, shared, 1);
+            throw;
+        }
+        return shared;
+    }
+
+    void Release() noexcept {
+        Shared* shared = std::exchange(shared_, nullptr);
+        if (shared != nullptr && shared->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            SharedAllocator alloc(alloc_);
+            SharedTraits::destroy(alloc, shared);
+            SharedTraits::deallocate(alloc, shared, 1);
+        }
+    }
+
+    [[no_unique_address]] Allocator alloc_;
+    Shared* shared_ = nullptr;
+};
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline auto operator<=>(const CowSimpleVector<Type, Allocator, GrowthPolicy>& lhs,
+                        const CowSimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return lhs.View() <=> rhs.View();
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator==(const CowSimpleVector<Type, Allocator, GrowthPolicy>& lhs,
+                       const CowSimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return lhs.View() == rhs.View();
+}
+
+namespace std {
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+    requires vector_hash::Hashable<Type>
+struct hash<CowSimpleVector<Type, Allocator, GrowthPolicy>> {
+    size_t operator()(const CowSimpleVector<Type, Allocator, GrowthPolicy>& items) const {
+        return static_cast<size_t>(items.Hash());
+    }
+};
+
+}  // namespace std
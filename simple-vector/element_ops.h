@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "instrumentation.h"
+#include "memory_copy.h"
+#include "parallel_chunks.h"
+
+// Types whose objects may be moved to another address with memcpy, leaving the
+// source storage to be released without running the destructor.
+// Specialize for types that own their resources through plain pointers.
+template <typename Type>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Type> {
+};
+
+// Constructs, destroys and relocates elements in uninitialized storage on behalf
+// of a container that owns the given allocator.
+template <typename Type, typename Allocator>
+class ElementOps {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    explicit ElementOps(Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Builds copies of [first, last) at dest for relocation. Trivially relocatable types
+    // are copied bytewise, nothrow-movable (or move-only) types are moved and the rest
+    // are copied, so a throwing relocation leaves the source elements untouched.
+    void UninitializedTransfer(Type* first, Type* last, Type* dest) {
+        if constexpr (IsTriviallyRelocatable<Type>::value) {
+            memory_copy::Copy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(Type));
+            VectorEvents<Type>::Relocation(RelocationKind::kBytewise, last - first);
+        } else if constexpr (std::is_nothrow_move_constructible_v<Type>
+                             || !std::is_copy_constructible_v<Type>) {
+            UninitializedMove(first, last, dest);
+            VectorEvents<Type>::Relocation(RelocationKind::kMove, last - first);
+        } else {
+            UninitializedCopy(first, last, dest);
+            VectorEvents<Type>::Relocation(RelocationKind::kCopy, last - first);
+        }
+    }
+
+    // Ends the lifetime of elements already transferred by UninitializedTransfer.
+    void DestroyTransferred(Type* first, Type* last) noexcept {
+        if constexpr (!IsTriviallyRelocatable<Type>::value) {
+            Destroy(first, last);
+        }
+    }
+
+    // Element lifetime goes through the allocator so that allocators customizing
+    // construct/destroy (e.g. uses-allocator construction) see every element.
+    // Allocators without such members take the std:: algorithms directly.
+    static constexpr bool kPlainConstruct = !requires(Allocator& alloc, Type* ptr) {
+        alloc.construct(ptr, std::declval<const Type&>());
+    };
+    static constexpr bool kPlainDestroy = !requires(Allocator& alloc, Type* ptr) {
+        alloc.destroy(ptr);
+    };
+
+    template <typename... Args>
+    void ConstructAt(Type* ptr, Args&&... args) {
+        AllocTraits::construct(alloc_, ptr, std::forward<Args>(args)...);
+    }
+
+    void DestroyAt(Type* ptr) noexcept {
+        AllocTraits::destroy(alloc_, ptr);
+    }
+
+    void Destroy(Type* first, Type* last) noexcept {
+        if constexpr (kPlainDestroy) {
+            std::destroy(first, last);
+        } else {
+            for (; first != last; ++first) {
+                DestroyAt(first);
+            }
+        }
+    }
+
+    template <typename InputIt, typename Sentinel>
+    Type* UninitializedCopy(InputIt first, Sentinel last, Type* dest) {
+        if constexpr (kPlainConstruct && std::is_trivially_copyable_v<Type> && kPointerTo<InputIt>
+                      && std::is_same_v<InputIt, Sentinel>) {
+            memory_copy::Copy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(Type));
+            return dest + (last - first);
+        } else if constexpr (kPlainConstruct && std::is_same_v<InputIt, Sentinel>) {
+            return std::uninitialized_copy(first, last, dest);
+        } else {
+            Type* current = dest;
+            try {
+                for (; first != last; ++first, ++current) {
+                    ConstructAt(current, *first);
+                }
+            } catch (...) {
+                Destroy(dest, current);
+                throw;
+            }
+            return current;
+        }
+    }
+
+    Type* UninitializedMove(Type* first, Type* last, Type* dest) {
+        return UninitializedCopy(std::make_move_iterator(first), std::make_move_iterator(last), dest);
+    }
+
+    // Value-initializes count elements at dest, or copies them from value when one is given.
+    template <typename... Value>
+    Type* UninitializedConstruct(Type* dest, size_t count, const Value&... value) {
+        static_assert(sizeof...(Value) <= 1);
+        if constexpr (kPlainConstruct) {
+            if constexpr (sizeof...(Value) == 0) {
+                return std::uninitialized_value_construct_n(dest, count);
+            } else {
+                return std::uninitialized_fill_n(dest, count, value...);
+            }
+        } else {
+            Type* current = dest;
+            try {
+                for (; count > 0; --count, ++current) {
+                    ConstructAt(current, value...);
+                }
+            } catch (...) {
+                Destroy(dest, current);
+                throw;
+            }
+            return current;
+        }
+    }
+
+    // UninitializedConstruct split into cache-aligned chunks run on executor. Allocators with
+    // their own construct are not assumed to be thread-safe and construct on this thread.
+    template <ParallelExecutor Executor, typename... Value>
+    Type* ParallelUninitializedConstruct(Executor& executor, Type* dest, size_t count, const Value&... value) {
+        const CacheAlignedChunks<Type> chunks(dest, count, executor.GetThreadCount());
+        if (!kPlainConstruct || chunks.GetCount() == 1) {
+            return UninitializedConstruct(dest, count, value...);
+        }
+        std::unique_ptr<bool[]> constructed(new bool[chunks.GetCount()]());
+        try {
+            executor.ParallelFor(chunks.GetCount(), [&](size_t index) {
+                UninitializedConstruct(chunks.First(index), chunks.Last(index) - chunks.First(index), value...);
+                constructed[index] = true;
+            });
+        } catch (...) {
+            for (size_t index = 0; index < chunks.GetCount(); ++index) {
+                if (constructed[index]) {
+                    Destroy(chunks.First(index), chunks.Last(index));
+                }
+            }
+            throw;
+        }
+        return dest + count;
+    }
+
+    // UninitializedCopy of a contiguous range split into cache-aligned chunks run on executor,
+    // with the same restriction on allocators as ParallelUninitializedConstruct
+    template <ParallelExecutor Executor>
+    Type* ParallelUninitializedCopy(Executor& executor, const Type* first, const Type* last, Type* dest) {
+        const size_t count = last - first;
+        if constexpr (kPlainConstruct && std::is_trivially_copyable_v<Type>) {
+            memory_copy::ParallelCopy(executor, static_cast<void*>(dest), static_cast<const void*>(first),
+                                      count * sizeof(Type));
+            return dest + count;
+        }
+        const CacheAlignedChunks<Type> chunks(dest, count, executor.GetThreadCount());
+        if (!kPlainConstruct || chunks.GetCount() == 1) {
+            return UninitializedCopy(first, last, dest);
+        }
+        std::unique_ptr<bool[]> constructed(new bool[chunks.GetCount()]());
+        try {
+            executor.ParallelFor(chunks.GetCount(), [&](size_t index) {
+                const Type* source = first + (chunks.First(index) - dest);
+                UninitializedCopy(source, source + (chunks.Last(index) - chunks.First(index)), chunks.First(index));
+                constructed[index] = true;
+            });
+        } catch (...) {
+            for (size_t index = 0; index < chunks.GetCount(); ++index) {
+                if (constructed[index]) {
+                    Destroy(chunks.First(index), chunks.Last(index));
+                }
+            }
+            throw;
+        }
+        return dest + count;
+    }
+
+private:
+    template <typename Iterator>
+    static constexpr bool kPointerTo = std::is_same_v<Iterator, Type*> || std::is_same_v<Iterator, const Type*>;
+
+    Allocator& alloc_;
+};
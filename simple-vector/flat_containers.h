@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+struct SortedUniqueTag {
+    explicit SortedUniqueTag() = default;
+};
+
+// Marks input that is already sorted and free of duplicate keys
+inline constexpr SortedUniqueTag sorted_unique{};
+
+namespace flat_detail {
+
+struct Identity {
+    template <typename Value>
+    const Value& operator()(const Value& value) const noexcept {
+        return value;
+    }
+};
+
+struct First {
+    template <typename Pair>
+    const auto& operator()(const Pair& pair) const noexcept {
+        return pair.first;
+    }
+};
+
+// Binary search without a data-dependent branch: the loop runs log2(size) times whatever
+// the key, and the compiler turns the step into a conditional move
+template <typename Value, typename Key, typename KeyOf, typename Compare>
+const Value* LowerBound(const Value* first, size_t size, const Key& key, const KeyOf& key_of, const Compare& comp) {
+    if (size == 0) {
+        return first;
+    }
+    while (size > 1) {
+        const size_t half = size / 2;
+        first = comp(key_of(first[half]), key) ? first + half : first;
+        size -= half;
+    }
+    return first + comp(key_of(*first), key);
+}
+
+// Sorted unique Values in a SimpleVector, ordered by KeyOf(value) under Compare.
+// Shared implementation of FlatSet and FlatMap.
+template <typename Value, typename KeyOf, typename Compare, typename Allocator>
+class FlatBase {
+protected:
+    using Vector = SimpleVector<Value, Allocator>;
+
+public:
+    using Iterator = Value*;
+    using ConstIterator = const Value*;
+    using value_type = Value;
+
+    FlatBase() = default;
+
+    explicit FlatBase(const Compare& comp, const Allocator& alloc = Allocator())
+        : items_(alloc)
+        , comp_(comp) {
+    }
+
+    FlatBase(SortedUniqueTag, Vector&& items, const Compare& comp = Compare())
+        : items_(std::move(items))
+        , comp_(comp) {
+        assert(std::ranges::adjacent_find(items_, [this](const Value& lhs, const Value& rhs) {
+            return !comp_(KeyOf()(lhs), KeyOf()(rhs));
+        }) == items_.end());
+    }
+
+    size_t GetSize() const noexcept {
+        return items_.GetSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return items_.GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept {
+        return items_.IsEmpty();
+    }
+
+    void Reserve(size_t new_capacity) {
+        items_.Reserve(new_capacity);
+    }
+
+    void ShrinkToFit() {
+        items_.ShrinkToFit();
+    }
+
+    void Clear() noexcept {
+        items_.Clear();
+    }
+
+    // The sorted values, contiguous
+    SimpleVectorView<const Value> View() const noexcept {
+        return SimpleVectorView<const Value>(items_.cbegin(), items_.GetSize());
+    }
+
+    ConstIterator begin() const noexcept {
+        return items_.begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return items_.end();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return items_.cbegin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return items_.cend();
+    }
+
+    // Lookups accept anything Compare can compare with the keys
+
+    template <typename Key>
+    ConstIterator LowerBound(const Key& key) const {
+        return flat_detail::LowerBound(items_.cbegin(), items_.GetSize(), key, KeyOf(), comp_);
+    }
+
+    template <typename Key>
+    ConstIterator UpperBound(const Key& key) const {
+        return std::upper_bound(items_.cbegin(), items_.cend(), key, [this](const Key& lhs, const Value& rhs) {
+            return comp_(lhs, KeyOf()(rhs));
+        });
+    }
+
+    template <typename Key>
+    ConstIterator Find(const Key& key) const {
+        ConstIterator pos = LowerBound(key);
+        return pos != end() && !comp_(key, KeyOf()(*pos)) ? pos : end();
+    }
+
+    template <typename Key>
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    template <typename Key>
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Returns the number of values removed, 0 or 1
+    template <typename Key>
+    size_t Erase(const Key& key) {
+        ConstIterator pos = Find(key);
+        if (pos == end()) {
+            return 0;
+        }
+        items_.Erase(pos);
+        return 1;
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        return items_.Erase(pos);
+    }
+
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        return items_.EraseIf(pred);
+    }
+
+    // Inserts a whole batch with one append, one sort of the batch and one merge. Keys that
+    // are already present, or repeated within the batch, keep the first value seen.
+    // Returns the number of values inserted.
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    size_t InsertBatch(InputIt first, Sentinel last) {
+        const size_t old_size = items_.GetSize();
+        items_.Append(std::move(first), std::move(last));
+        const auto less = [this](const Value& lhs, const Value& rhs) {
+            return comp_(KeyOf()(lhs), KeyOf()(rhs));
+        };
+        const auto equivalent = [&less](const Value& lhs, const Value& rhs) {
+            return !less(lhs, rhs);
+        };
+        Iterator middle = items_.begin() + old_size;
+        std::stable_sort(middle, items_.end(), less);
+        // the merge is stable, so an existing value precedes a new one with the same key
+        std::inplace_merge(items_.begin(), middle, items_.end(), less);
+        items_.EraseRange(std::unique(items_.begin(), items_.end(), equivalent), items_.end());
+        return items_.GetSize() - old_size;
+    }
+
+    template <std::ranges::input_range Range>
+    size_t InsertBatch(Range&& range) {
+        return InsertBatch(std::ranges::begin(range), std::ranges::end(range));
+    }
+
+    friend bool operator==(const FlatBase& lhs, const FlatBase& rhs) {
+        return lhs.items_ == rhs.items_;
+    }
+
+    friend auto operator<=>(const FlatBase& lhs, const FlatBase& rhs) {
+        return lhs.items_ <=> rhs.items_;
+    }
+
+protected:
+    // Position where a value with key belongs and whether one is already there
+    template <typename Key>
+    std::pair<size_t, bool> Locate(const Key& key) const {
+        ConstIterator pos = LowerBound(key);
+        return {static_cast<size_t>(pos - items_.cbegin()), pos != end() && !comp_(key, KeyOf()(*pos))};
+    }
+
+    Vector items_;
+    [[no_unique_address]] Compare comp_;
+};
+
+}  // namespace flat_detail
+
+// Sorted set of unique keys in one contiguous SimpleVector. Lookups are a branchless
+// binary search; build from a whole range, or merge batches with InsertBatch, rather
+// than inserting one key after another, which shifts the tail every time.
+template <typename Key, typename Compare = std::less<>, typename Allocator = std::allocator<Key>>
+class FlatSet : public flat_detail::FlatBase<Key, flat_detail::Identity, Compare, Allocator> {
+    using Base = flat_detail::FlatBase<Key, flat_detail::Identity, Compare, Allocator>;
+
+public:
+    using typename Base::ConstIterator;
+    using typename Base::Iterator;
+
+    using Base::Base;
+
+    FlatSet() = default;
+
+    FlatSet(std::initializer_list<Key> init, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : FlatSet(init.begin(), init.end(), comp, alloc) {
+    }
+
+    // One sort and one dedupe for the whole range
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    FlatSet(InputIt first, Sentinel last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : Base(comp, alloc) {
+        this->InsertBatch(std::move(first), std::move(last));
+    }
+
+    template <typename Value>
+    std::pair<ConstIterator, bool> Insert(Value&& key) {
+        const auto [index, found] = this->Locate(key);
+        if (!found) {
+            this->items_.Insert(this->items_.cbegin() + index, Key(std::forward<Value>(key)));
+        }
+        return {this->items_.cbegin() + index, !found};
+    }
+};
+
+// Sorted map of unique keys to values, stored as std::pair<Key, Value> in one contiguous
+// SimpleVector, with the lookups and batch building of FlatSet. Keys must not be changed
+// through iterators.
+template <typename Key, typename Value, typename Compare = std::less<>,
+          typename Allocator = std::allocator<std::pair<Key, Value>>>
+class FlatMap : public flat_detail::FlatBase<std::pair<Key, Value>, flat_detail::First, Compare, Allocator> {
+    using Base = flat_detail::FlatBase<std::pair<Key, Value>, flat_detail::First, Compare, Allocator>;
+
+public:
+    using typename Base::ConstIterator;
+    using typename Base::Iterator;
+
+    using Base::Base;
+    using Base::begin;
+    using Base::end;
+    using Base::Find;
+
+    FlatMap() = default;
+
+    FlatMap(std::initializer_list<std::pair<Key, Value>> init, const Compare& comp = Compare(),
+            const Allocator& alloc = Allocator())
+        : FlatMap(init.begin(), init.end(), comp, alloc) {
+    }
+
+    // One sort and one dedupe for the whole range; the first value of a repeated key wins
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    FlatMap(InputIt first, Sentinel last, const Compare& comp = Compare(), const Allocator& alloc = Allocator())
+        : Base(comp, alloc) {
+        this->InsertBatch(std::move(first), std::move(last));
+    }
+
+    Iterator begin() noexcept {
+        return this->items_.begin();
+    }
+
+    Iterator end() noexcept {
+        return this->items_.end();
+    }
+
+    template <typename KeyLike>
+    Iterator Find(const KeyLike& key) {
+        return begin() + (std::as_const(*this).Find(key) - this->cbegin());
+    }
+
+    template <typename KeyLike>
+    Value& At(const KeyLike& key) {
+        return const_cast<Value&>(std::as_const(*this).At(key));
+    }
+
+    template <typename KeyLike>
+    const Value& At(const KeyLike& key) const {
+        ConstIterator pos = Find(key);
+        if (pos == this->cend()) {
+            throw std::out_of_range("Key not found");
+        }
+        return pos->second;
+    }
+
+    // Inserts a value-initialized Value if key is missing
+    Value& operator[](const Key& key) {
+        return TryEmplace(key).first->second;
+    }
+
+    // Does nothing if key is present
+    template <typename... Args>
+    std::pair<Iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+        const auto [index, found] = this->Locate(key);
+        if (!found) {
+            this->items_.Emplace(this->items_.cbegin() + index, std::piecewise_construct, std::forward_as_tuple(key),
+                                 std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        return {begin() + index, !found};
+    }
+
+    std::pair<Iterator, bool> Insert(const std::pair<Key, Value>& entry) {
+        return TryEmplace(entry.first, entry.second);
+    }
+
+    template <typename Mapped>
+    std::pair<Iterator, bool> InsertOrAssign(const Key& key, Mapped&& value) {
+        auto result = TryEmplace(key, std::forward<Mapped>(value));
+        if (!result.second) {
+            result.first->second = std::forward<Mapped>(value);
+        }
+        return result;
+    }
+};
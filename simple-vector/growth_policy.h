@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+// Growth policies decide the capacity a vector reallocates to once it needs room
+// for at least required elements of element_size bytes.
+
+struct DoublingGrowth {
+    static size_t NewCapacity(size_t capacity, size_t required, size_t /*element_size*/) {
+        return std::max(capacity * 2, required);
+    }
+};
+
+struct OneAndHalfGrowth {
+    static size_t NewCapacity(size_t capacity, size_t required, size_t /*element_size*/) {
+        return std::max(capacity + capacity / 2, required);
+    }
+};
+
+// Grows by 1.5x and rounds the allocation up to what the allocator hands out anyway:
+// malloc-style size classes for small blocks, whole pages for medium ones and whole
+// huge pages once the buffer reaches HugeThreshold bytes.
+template <size_t PageSize = 4096, size_t HugePageSize = 2 * 1024 * 1024, size_t HugeThreshold = 32 * 1024 * 1024>
+struct SizeClassGrowth {
+    static_assert(std::has_single_bit(PageSize) && std::has_single_bit(HugePageSize));
+
+    static size_t NewCapacity(size_t capacity, size_t required, size_t element_size) {
+        const size_t target = std::max(capacity + capacity / 2, required);
+        return std::max(RoundUpBytes(target * element_size) / element_size, target);
+    }
+
+    static size_t RoundUpBytes(size_t bytes) {
+        if (bytes <= 128) {
+            return RoundUp(bytes, 16);
+        }
+        if (bytes < PageSize) {
+            // four classes between consecutive powers of two
+            return RoundUp(bytes, std::bit_floor(bytes - 1) / 4);
+        }
+        if (bytes < HugeThreshold) {
+            return RoundUp(bytes, PageSize);
+        }
+        return RoundUp(bytes, HugePageSize);
+    }
+
+private:
+    static size_t RoundUp(size_t value, size_t step) {
+        return (value + step - 1) / step * step;
+    }
+};
+
+// Adds shrinking to another policy: once the size drops below a quarter of the
+// capacity the buffer is reallocated to half of it.
+template <typename BasePolicy = DoublingGrowth>
+struct AutoShrink : BasePolicy {
+    static size_t ShrinkCapacity(size_t capacity, size_t size) {
+        return size < capacity / 4 ? capacity / 2 : capacity;
+    }
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+// Opt-in allocation and growth counters for the containers in this library.
+// Define SIMPLE_VECTOR_INSTRUMENTATION before including any of the headers to enable them;
+// otherwise every hook is an empty inline function and compiles away.
+#ifdef SIMPLE_VECTOR_INSTRUMENTATION
+inline constexpr bool kVectorInstrumentation = true;
+#else
+inline constexpr bool kVectorInstrumentation = false;
+#endif
+
+struct VectorStatsSnapshot {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t allocated_bytes = 0;
+    uint64_t reallocations = 0;
+    uint64_t elements_relocated_bytewise = 0;
+    uint64_t elements_moved = 0;
+    uint64_t elements_copied = 0;
+    uint64_t bytes_relocated = 0;
+    uint64_t insert_shifts = 0;
+    uint64_t elements_shifted = 0;
+    uint64_t peak_capacity_bytes = 0;
+};
+
+enum class RelocationKind {
+    kBytewise,
+    kMove,
+    kCopy,
+};
+
+class VectorStats {
+public:
+    void RecordAllocation(size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        uint64_t peak = peak_capacity_bytes_.load(std::memory_order_relaxed);
+        while (peak < bytes && !peak_capacity_bytes_.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+    }
+
+    void RecordDeallocation() noexcept {
+        deallocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordReallocation() noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordRelocation(RelocationKind kind, size_t count, size_t bytes) noexcept {
+        switch (kind) {
+            case RelocationKind::kBytewise:
+                elements_relocated_bytewise_.fetch_add(count, std::memory_order_relaxed);
+                break;
+            case RelocationKind::kMove:
+                elements_moved_.fetch_add(count, std::memory_order_relaxed);
+                break;
+            case RelocationKind::kCopy:
+                elements_copied_.fetch_add(count, std::memory_order_relaxed);
+                break;
+        }
+        bytes_relocated_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void RecordShift(size_t count) noexcept {
+        insert_shifts_.fetch_add(1, std::memory_order_relaxed);
+        elements_shifted_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    VectorStatsSnapshot Snapshot() const noexcept {
+        VectorStatsSnapshot snapshot;
+        snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+        snapshot.deallocations = deallocations_.load(std::memory_order_relaxed);
+        snapshot.allocated_bytes = allocated_bytes_.load(std::memory_order_relaxed);
+        snapshot.reallocations = reallocations_.load(std::memory_order_relaxed);
+        snapshot.elements_relocated_bytewise = elements_relocated_bytewise_.load(std::memory_order_relaxed);
+        snapshot.elements_moved = elements_moved_.load(std::memory_order_relaxed);
+        snapshot.elements_copied = elements_copied_.load(std::memory_order_relaxed);
+        snapshot.bytes_relocated = bytes_relocated_.load(std::memory_order_relaxed);
+        snapshot.insert_shifts = insert_shifts_.load(std::memory_order_relaxed);
+        snapshot.elements_shifted = elements_shifted_.load(std::memory_order_relaxed);
+        snapshot.peak_capacity_bytes = peak_capacity_bytes_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    void Reset() noexcept {
+        for (auto* counter : {&allocations_, &deallocations_, &allocated_bytes_, &reallocations_,
+                              &elements_relocated_bytewise_, &elements_moved_, &elements_copied_,
+                              &bytes_relocated_, &insert_shifts_, &elements_shifted_, &peak_capacity_bytes_}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<uint64_t> allocations_{0};
+    std::atomic<uint64_t> deallocations_{0};
+    std::atomic<uint64_t> allocated_bytes_{0};
+    std::atomic<uint64_t> reallocations_{0};
+    std::atomic<uint64_t> elements_relocated_bytewise_{0};
+    std::atomic<uint64_t> elements_moved_{0};
+    std::atomic<uint64_t> elements_copied_{0};
+    std::atomic<uint64_t> bytes_relocated_{0};
+    std::atomic<uint64_t> insert_shifts_{0};
+    std::atomic<uint64_t> elements_shifted_{0};
+    std::atomic<uint64_t> peak_capacity_bytes_{0};
+};
+
+// Receives the counters from ExportVectorStats, e.g. to forward them to a metrics pipeline.
+// scope is "global" for the totals and the element type name for per-type counters.
+class VectorStatsExporter {
+public:
+    virtual ~VectorStatsExporter() = default;
+    virtual void Export(std::string_view scope, const VectorStatsSnapshot& stats) = 0;
+};
+
+class VectorStatsRegistry {
+public:
+    static VectorStatsRegistry& Instance() {
+        static VectorStatsRegistry registry;
+        return registry;
+    }
+
+    VectorStats& Global() noexcept {
+        return global_;
+    }
+
+    void Register(std::string name, VectorStats* stats) {
+        std::lock_guard guard(mutex_);
+        entries_.push_back({std::move(name), stats});
+    }
+
+    void Export(VectorStatsExporter& exporter) {
+        exporter.Export("global", global_.Snapshot());
+        std::lock_guard guard(mutex_);
+        for (const auto& entry : entries_) {
+            exporter.Export(entry.name, entry.stats->Snapshot());
+        }
+    }
+
+    void Reset() noexcept {
+        global_.Reset();
+        std::lock_guard guard(mutex_);
+        for (const auto& entry : entries_) {
+            entry.stats->Reset();
+        }
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        VectorStats* stats;
+    };
+
+    VectorStats global_;
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+template <typename Type>
+std::string VectorTypeName() {
+    const char* name = typeid(Type).name();
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled != nullptr) {
+        std::string result(demangled);
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+inline VectorStats& GlobalVectorStats() noexcept {
+    return VectorStatsRegistry::Instance().Global();
+}
+
+template <typename Type>
+VectorStats& VectorStatsOf() {
+    static VectorStats& stats = [] () -> VectorStats& {
+        static VectorStats instance;
+        VectorStatsRegistry::Instance().Register(VectorTypeName<Type>(), &instance);
+        return instance;
+    }();
+    return stats;
+}
+
+inline void ExportVectorStats(VectorStatsExporter& exporter) {
+    VectorStatsRegistry::Instance().Export(exporter);
+}
+
+inline void ResetVectorStats() noexcept {
+    VectorStatsRegistry::Instance().Reset();
+}
+
+// Hooks called by the containers, recorded both globally and per element type
+template <typename Type>
+struct VectorEvents {
+    static void Allocation(size_t count) noexcept {
+        if constexpr (kVectorInstrumentation) {
+            GlobalVectorStats().RecordAllocation(count * sizeof(Type));
+            PerType().RecordAllocation(count * sizeof(Type));
+        }
+    }
+
+    static void Deallocation() noexcept {
+        if constexpr (kVectorInstrumentation) {
+            GlobalVectorStats().RecordDeallocation();
+            PerType().RecordDeallocation();
+        }
+    }
+
+    static void Reallocation() noexcept {
+        if constexpr (kVectorInstrumentation) {
+            GlobalVectorStats().RecordReallocation();
+            PerType().RecordReallocation();
+        }
+    }
+
+    static void Relocation(RelocationKind kind, size_t count) noexcept {
+        if constexpr (kVectorInstrumentation) {
+            GlobalVectorStats().RecordRelocation(kind, count, count * sizeof(Type));
+            PerType().RecordRelocation(kind, count, count * sizeof(Type));
+        }
+    }
+
+    static void Shift(size_t count) noexcept {
+        if constexpr (kVectorInstrumentation) {
+            GlobalVectorStats().RecordShift(count);
+            PerType().RecordShift(count);
+        }
+    }
+
+private:
+    static VectorStats& PerType() noexcept {
+        // registration allocates; an exhausted heap only costs the per-type breakdown
+        try {
+            return VectorStatsOf<Type>();
+        } catch (...) {
+            static VectorStats discarded;
+            return discarded;
+        }
+    }
+};
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <system_error>
+#include <type_traits>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "simple_vector.h"
+
+enum class HugePages {
+    // Regular pages
+    kNone,
+    // 2 MiB aligned mapping with madvise(MADV_HUGEPAGE), served by transparent huge pages
+    kTransparent,
+    // Explicit hugetlbfs pages, which need pages reserved through vm.nr_hugepages.
+    // Falls back to kTransparent when none are available.
+    k2MiB,
+    k1GiB,
+};
+
+enum class NumaPolicy {
+    kDefault,
+    // Pages come from numa_node only
+    kBind,
+    // Pages are spread round-robin over all nodes
+    kInterleave,
+};
+
+struct LargePageOptions {
+    HugePages huge_pages = HugePages::kTransparent;
+    NumaPolicy numa = NumaPolicy::kDefault;
+    int numa_node = 0;
+    // Touch every page on allocation so the first scan does not take the page faults
+    bool prefault = false;
+    // Smaller blocks go to operator new unchanged
+    size_t min_bytes = size_t{2} << 20;
+
+    friend bool operator==(const LargePageOptions&, const LargePageOptions&) = default;
+};
+
+namespace large_pages {
+
+inline constexpr size_t kSmallPage = 4096;
+inline constexpr size_t k2MiB = size_t{2} << 20;
+inline constexpr size_t k1GiB = size_t{1} << 30;
+
+inline size_t PageBytes(HugePages huge_pages) noexcept {
+    switch (huge_pages) {
+        case HugePages::kNone:
+            return kSmallPage;
+        case HugePages::kTransparent:
+        case HugePages::k2MiB:
+            return k2MiB;
+        case HugePages::k1GiB:
+            return k1GiB;
+    }
+    return kSmallPage;
+}
+
+inline size_t RoundToPages(size_t bytes, size_t page) noexcept {
+    return (bytes + page - 1) / page * page;
+}
+
+// A k1GiB mapping that found no gigantic pages is a transparent one of 2 MiB pages,
+// placed at an address that is not 1 GiB aligned so that Unmap can tell it apart
+inline bool IsFallbackMapping(const void* mapping, const LargePageOptions& options) noexcept {
+    return options.huge_pages == HugePages::k1GiB && reinterpret_cast<uintptr_t>(mapping) % k1GiB != 0;
+}
+
+// Page size, and so the rounding of the length, of mapping; Map and Unmap must agree on it
+inline size_t MappingPage(const void* mapping, const LargePageOptions& options) noexcept {
+    return IsFallbackMapping(mapping, options) ? k2MiB : PageBytes(options.huge_pages);
+}
+
+inline void* MapAnonymous(size_t bytes, int extra_flags) noexcept {
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+    return mapping == MAP_FAILED ? nullptr : mapping;
+}
+
+// Maps bytes at an address aligned to alignment, and not to avoided_alignment when that
+// is given, by over-mapping and trimming both ends
+inline void* MapAligned(size_t bytes, size_t alignment, size_t avoided_alignment = 0) noexcept {
+    if (alignment <= kSmallPage && avoided_alignment == 0) {
+        return MapAnonymous(bytes, 0);
+    }
+    const size_t slack = avoided_alignment == 0 ? alignment : 2 * alignment;
+    auto* mapping = static_cast<char*>(MapAnonymous(bytes + slack, 0));
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+    const auto address = reinterpret_cast<uintptr_t>(mapping);
+    size_t head = (alignment - address % alignment) % alignment;
+    if (avoided_alignment != 0 && (address + head) % avoided_alignment == 0) {
+        head += alignment;
+    }
+    if (head > 0) {
+        ::munmap(mapping, head);
+    }
+    ::munmap(mapping + head + bytes, slack - head);
+    return mapping + head;
+}
+
+// Placement is a hint: kernels without NUMA support (ENOSYS) or a single node keep the
+// default policy, anything else the kernel rejects is reported
+inline void BindToNodes(void* mapping, size_t bytes, const LargePageOptions& options) {
+    if (options.numa == NumaPolicy::kDefault) {
+        return;
+    }
+    constexpr size_t kMaxNodes = sizeof(unsigned long) * CHAR_BIT;
+    unsigned long nodes = ~0ul;
+    int mode = MPOL_INTERLEAVE;
+    if (options.numa == NumaPolicy::kBind) {
+        if (options.numa_node < 0 || static_cast<size_t>(options.numa_node) >= kMaxNodes) {
+            throw std::system_error(EINVAL, std::generic_category(), "mbind");
+        }
+        nodes = 1ul << options.numa_node;
+        mode = MPOL_BIND;
+    }
+    // the kernel reads maxnode - 1 bits of the mask, so pass one more to reach the last node
+    if (::syscall(SYS_mbind, mapping, bytes, mode, &nodes, kMaxNodes + 1, 0) != 0) {
+        const int error = errno;
+        // an interleave mask naming absent nodes is EINVAL too; only the present ones are used then
+        if (error == ENOSYS || error == EPERM || (error == EINVAL && mode == MPOL_INTERLEAVE)) {
+            return;
+        }
+        throw std::system_error(error, std::generic_category(), "mbind");
+    }
+}
+
+inline void* Map(size_t bytes, const LargePageOptions& options) {
+    size_t length = RoundToPages(bytes, PageBytes(options.huge_pages));
+    void* mapping = nullptr;
+    if (options.huge_pages == HugePages::k2MiB || options.huge_pages == HugePages::k1GiB) {
+        const int shift = options.huge_pages == HugePages::k2MiB ? 21 : 30;
+        mapping = MapAnonymous(length, MAP_HUGETLB | (shift << MAP_HUGE_SHIFT));
+    }
+    if (mapping == nullptr) {
+        if (options.huge_pages == HugePages::k1GiB) {
+            // 2 MiB transparent pages rather than a whole gigabyte of them
+            length = RoundToPages(bytes, k2MiB);
+            mapping = MapAligned(length, k2MiB, k1GiB);
+        } else {
+            mapping = MapAligned(length, PageBytes(options.huge_pages));
+        }
+        if (mapping == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (options.huge_pages != HugePages::kNone) {
+            ::madvise(mapping, length, MADV_HUGEPAGE);
+        }
+    }
+    try {
+        BindToNodes(mapping, length, options);
+    } catch (...) {
+        ::munmap(mapping, length);
+        throw;
+    }
+    if (options.prefault) {
+        // one write per small page of the block itself, not of the rounding past its end;
+        // policy and huge pages are in place, so this faults in the right ones
+        auto* bytes_ptr = static_cast<volatile char*>(mapping);
+        for (size_t offset = 0; offset < bytes; offset += kSmallPage) {
+            bytes_ptr[offset] = 0;
+        }
+    }
+    return mapping;
+}
+
+inline void Unmap(void* mapping, size_t bytes, const LargePageOptions& options) noexcept {
+    ::munmap(mapping, RoundToPages(bytes, MappingPage(mapping, options)));
+}
+
+}  // namespace large_pages
+
+// Allocator for large vectors: blocks of at least options.min_bytes are mapped directly,
+// rounded up to whole (huge) pages, with the requested huge page size, NUMA placement
+// and prefaulting. Smaller blocks come from operator new. Allocators with the same
+// options are interchangeable.
+//
+//     LargePageSimpleVector<float> features(Reserve(n), LargePageAllocator<float>(
+//         {.huge_pages = HugePages::kTransparent, .numa = NumaPolicy::kInterleave}));
+template <typename T>
+class LargePageAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    LargePageAllocator() noexcept = default;
+
+    explicit LargePageAllocator(const LargePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    LargePageAllocator(const LargePageAllocator<U>& other) noexcept
+        : options_(other.GetOptions()) {
+    }
+
+    const LargePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(T);
+        if (bytes < options_.min_bytes) {
+            return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+        }
+        return static_cast<T*>(large_pages::Map(bytes, options_));
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (bytes < options_.min_bytes) {
+            ::operator delete(ptr, std::align_val_t(alignof(T)));
+        } else {
+            large_pages::Unmap(ptr, bytes, options_);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const LargePageAllocator<U>& other) const noexcept {
+        return options_ == other.GetOptions();
+    }
+
+private:
+    LargePageOptions options_;
+};
+
+template <typename Type, typename GrowthPolicy = SizeClassGrowth<>>
+using LargePageSimpleVector = SimpleVector<Type, LargePageAllocator<Type>, GrowthPolicy>;
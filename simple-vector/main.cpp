@@ -1,8 +1,38 @@
+#define SIMPLE_VECTOR_INSTRUMENTATION
+
 #include "simple_vector.h"
+#include "small_simple_vector.h"
+#include "parallel_algorithms.h"
+#include "concurrent_simple_vector.h"
+#include "buffer_pool.h"
+#include "mapped_simple_vector.h"
+#include "simple_vector_view.h"
+#include "cow_simple_vector.h"
+#include "soa_simple_vector.h"
+#include "segmented_simple_vector.h"
+#include "large_page_allocator.h"
+#include "static_simple_vector.h"
+#include "simple_bit_vector.h"
+#include "vector_stream.h"
+#include "tombstone_simple_vector.h"
+#include "flat_containers.h"
+#include "vector_hash.h"
+#include "pmr_simple_vector.h"
 
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <list>
+#include <map>
+#include <memory_resource>
 #include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 using namespace std;
 
@@ -18,30 +48,286 @@ public:
     X& operator=(const X& other) = delete;
     X(X&& other) {
         x_ = exchange(other.x_, 0);
+        ++moves;
     }
     X& operator=(X&& other) {
         x_ = exchange(other.x_, 0);
+        ++moves;
         return *this;
     }
     size_t GetX() const {
         return x_;
     }
 
+    static inline size_t moves = 0;
+
 private:
     size_t x_;
 };
 
+class NoDefault {
+public:
+    explicit NoDefault(int value)
+        : value_(value) {
+        ++alive;
+    }
+    NoDefault(const NoDefault& other)
+        : value_(other.value_) {
+        ++alive;
+    }
+    NoDefault(NoDefault&& other)
+        : value_(exchange(other.value_, 0)) {
+        ++alive;
+    }
+    NoDefault& operator=(const NoDefault& other) = default;
+    NoDefault& operator=(NoDefault&& other) {
+        value_ = exchange(other.value_, 0);
+        return *this;
+    }
+    ~NoDefault() {
+        --alive;
+    }
+    int GetValue() const {
+        return value_;
+    }
+
+    static inline int alive = 0;
+
+private:
+    int value_;
+};
+
+template <bool NothrowMove>
+class Tracked {
+public:
+    Tracked(int value = 0)
+        : value_(value) {
+    }
+    Tracked(const Tracked& other)
+        : value_(other.value_) {
+        ++copies;
+    }
+    Tracked(Tracked&& other) noexcept(NothrowMove)
+        : value_(exchange(other.value_, 0)) {
+        ++moves;
+    }
+    Tracked& operator=(const Tracked& other) {
+        value_ = other.value_;
+        ++copies;
+        return *this;
+    }
+    Tracked& operator=(Tracked&& other) noexcept(NothrowMove) {
+        value_ = exchange(other.value_, 0);
+        ++moves;
+        return *this;
+    }
+    int GetValue() const {
+        return value_;
+    }
+
+    static void ResetCounters() {
+        copies = 0;
+        moves = 0;
+    }
+
+    static inline int copies = 0;
+    static inline int moves = 0;
+
+private:
+    int value_;
+};
+
+// Special member calls counted by Counted
+struct OperationCounts {
+    size_t constructions = 0;
+    size_t copy_constructions = 0;
+    size_t copy_assignments = 0;
+    size_t move_constructions = 0;
+    size_t move_assignments = 0;
+    size_t destructions = 0;
+
+    size_t Copies() const {
+        return copy_constructions + copy_assignments;
+    }
+    size_t Moves() const {
+        return move_constructions + move_assignments;
+    }
+    // Objects created minus objects destroyed
+    ptrdiff_t Alive() const {
+        return static_cast<ptrdiff_t>(constructions + copy_constructions + move_constructions)
+               - static_cast<ptrdiff_t>(destructions);
+    }
+};
+
+// Counts every special member call, for the operation budgets below
+class Counted {
+public:
+    using Counts = OperationCounts;
+
+    Counted(int value = 0) noexcept
+        : value_(value) {
+        ++counts.constructions;
+    }
+    Counted(const Counted& other) noexcept
+        : value_(other.value_) {
+        ++counts.copy_constructions;
+    }
+    Counted(Counted&& other) noexcept
+        : value_(exchange(other.value_, 0)) {
+        ++counts.move_constructions;
+    }
+    Counted& operator=(const Counted& other) noexcept {
+        value_ = other.value_;
+        ++counts.copy_assignments;
+        return *this;
+    }
+    Counted& operator=(Counted&& other) noexcept {
+        value_ = exchange(other.value_, 0);
+        ++counts.move_assignments;
+        return *this;
+    }
+    ~Counted() {
+        ++counts.destructions;
+    }
+    int GetValue() const {
+        return value_;
+    }
+    bool operator==(const Counted& other) const {
+        return value_ == other.value_;
+    }
+
+    // Returns the counts so far and starts over
+    static Counts Reset() {
+        return exchange(counts, Counts{});
+    }
+
+    static inline Counts counts;
+
+private:
+    int value_;
+};
+
+// Prints what an operation cost. Going over budget fails in NDEBUG builds too, so a change
+// that adds hidden copies, moves or allocations cannot pass unnoticed.
+void CheckBudget(string_view operation, string_view cost, uint64_t actual, uint64_t budget) {
+    cout << "  " << operation << ": " << actual << ' ' << cost << " (budget " << budget << ")" << endl;
+    if (actual > budget) {
+        cerr << operation << " is over budget: " << actual << ' ' << cost << ", budget " << budget << endl;
+        abort();
+    }
+}
+
+uint64_t AllocationsSinceReset() {
+    return GlobalVectorStats().Snapshot().allocations;
+}
+
+struct Arena {
+    size_t allocations = 0;
+    size_t bytes_in_use = 0;
+};
+
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena) noexcept
+        : arena_(&arena) {
+    }
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.GetArena()) {
+    }
+
+    T* allocate(size_t n) {
+        ++arena_->allocations;
+        arena_->bytes_in_use += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        arena_->bytes_in_use -= n * sizeof(T);
+        ::operator delete(ptr);
+    }
+
+    Arena* GetArena() const noexcept {
+        return arena_;
+    }
+    bool operator==(const ArenaAllocator& other) const noexcept {
+        return arena_ == other.arena_;
+    }
+
+private:
+    Arena* arena_;
+};
+
 SimpleVector<int> GenerateVector(size_t size) {
-    SimpleVector<int> v(size);
-    iota(v.begin(), v.end(), 1);
+    SimpleVector<int> v;
+    int* data = v.ResizeUninitialized(size);
+    iota(data, data + size, 1);
     return v;
 }
 
+// Throws from the constructor once the given number of objects has been built
+struct ThrowingCounter {
+    ThrowingCounter() {
+        if (built.fetch_add(1) + 1 == throw_at) {
+            throw runtime_error("construction failed");
+        }
+        alive.fetch_add(1);
+    }
+    ThrowingCounter(const ThrowingCounter&) = delete;
+    ~ThrowingCounter() {
+        alive.fetch_sub(1);
+    }
+
+    static inline atomic<size_t> built = 0;
+    static inline atomic<int> alive = 0;
+    static inline size_t throw_at = 0;
+};
+
+struct Point {
+    int x;
+    double y;
+};
+
+struct FlakyField {
+    FlakyField() {
+        if (--budget == 0) {
+            throw runtime_error("construction failed");
+        }
+        ++alive;
+    }
+    FlakyField(const FlakyField&) noexcept {
+        ++alive;
+    }
+    ~FlakyField() {
+        --alive;
+    }
+
+    static inline int budget = -1;
+    static inline int alive = 0;
+};
+
+// Copy-only: the copy throws once budget runs out, and there is no move to fall back on
+struct FlakyCopy {
+    FlakyCopy() = default;
+    FlakyCopy(const FlakyCopy&) {
+        if (--budget == 0) {
+            throw runtime_error("copy failed");
+        }
+    }
+
+    static inline int budget = -1;
+};
+
 void TestTemporaryObjConstructor() {
     const size_t size = 1000000;
     cout << "Test with temporary object, copy elision" << endl;
+    ResetVectorStats();
     SimpleVector<int> moved_vector(GenerateVector(size));
     assert(moved_vector.GetSize() == size);
+    // the one allocation is GenerateVector's
+    CheckBudget("Construction from a temporary", "allocations", AllocationsSinceReset(), 1);
     cout << "Done!" << endl << endl;
 }
 
@@ -50,8 +336,10 @@ void TestTemporaryObjOperator() {
     cout << "Test with temporary object, operator=" << endl;
     SimpleVector<int> moved_vector;
     assert(moved_vector.GetSize() == 0);
+    ResetVectorStats();
     moved_vector = GenerateVector(size);
     assert(moved_vector.GetSize() == size);
+    CheckBudget("Assignment from a temporary", "allocations", AllocationsSinceReset(), 1);
     cout << "Done!" << endl << endl;
 }
 
@@ -61,9 +349,11 @@ void TestNamedMoveConstructor() {
     SimpleVector<int> vector_to_move(GenerateVector(size));
     assert(vector_to_move.GetSize() == size);
 
+    ResetVectorStats();
     SimpleVector<int> moved_vector(move(vector_to_move));
     assert(moved_vector.GetSize() == size);
     assert(vector_to_move.GetSize() == 0);
+    CheckBudget("Move construction", "allocations", AllocationsSinceReset(), 0);
     cout << "Done!" << endl << endl;
 }
 
@@ -73,9 +363,12 @@ void TestNamedMoveOperator() {
     SimpleVector<int> vector_to_move(GenerateVector(size));
     assert(vector_to_move.GetSize() == size);
 
-    SimpleVector<int> moved_vector = move(vector_to_move);
+    SimpleVector<int> moved_vector;
+    ResetVectorStats();
+    moved_vector = move(vector_to_move);
     assert(moved_vector.GetSize() == size);
     assert(vector_to_move.GetSize() == 0);
+    CheckBudget("Move assignment", "allocations", AllocationsSinceReset(), 0);
     cout << "Done!" << endl << endl;
 }
 
@@ -87,9 +380,11 @@ void TestNoncopiableMoveConstructor() {
         vector_to_move.PushBack(X(i));
     }
 
+    X::moves = 0;
     SimpleVector<X> moved_vector = move(vector_to_move);
     assert(moved_vector.GetSize() == size);
     assert(vector_to_move.GetSize() == 0);
+    CheckBudget("Move construction of noncopiable elements", "moves", X::moves, 0);
 
     for (size_t i = 0; i < size; ++i) {
         assert(moved_vector[i].GetX() == i);
@@ -101,9 +396,12 @@ void TestNoncopiablePushBack() {
     const size_t size = 5;
     cout << "Test noncopiable push back" << endl;
     SimpleVector<X> v;
+    X::moves = 0;
     for (size_t i = 0; i < size; ++i) {
         v.PushBack(X(i));
     }
+    // one move into the vector each, plus fewer than 2n relocating moves while doubling
+    CheckBudget("PushBack of 5 noncopiable elements", "moves", X::moves, 3 * size);
 
     assert(v.GetSize() == size);
 
@@ -121,7 +419,10 @@ void TestNoncopiableInsert() {
         v.PushBack(X(i));
     }
 
+    X::moves = 0;
     v.Insert(v.begin(), X(size + 1));
+    // the value out of the argument, the shift of all five and the value into place
+    CheckBudget("Insert at the front of 5", "moves", X::moves, size + 2);
     assert(v.GetSize() == size + 1);
     assert(v.begin()->GetX() == size + 1);
     v.Insert(v.end(), X(size + 2));
@@ -141,8 +442,1791 @@ void TestNoncopiableErase() {
         v.PushBack(X(i));
     }
 
+    X::moves = 0;
     auto it = v.Erase(v.begin());
     assert(it->GetX() == 1);
+    CheckBudget("Erase at the front of 3", "moves", X::moves, size - 1);
+    cout << "Done!" << endl << endl;
+}
+
+void TestReserveWithoutConstruction() {
+    cout << "Test reserve without default construction" << endl;
+    {
+        SimpleVector<NoDefault> v(Reserve(10));
+        assert(v.GetCapacity() == 10);
+        assert(NoDefault::alive == 0);
+        for (int i = 0; i < 20; ++i) {
+            v.PushBack(NoDefault(i));
+        }
+        assert(NoDefault::alive == 20);
+        v.Reserve(100);
+        assert(v.GetCapacity() == 100);
+        assert(NoDefault::alive == 20);
+        for (int i = 0; i < 20; ++i) {
+            assert(v[i].GetValue() == i);
+        }
+        v.PopBack();
+        v.Erase(v.begin());
+        assert(NoDefault::alive == 18);
+        v.Clear();
+        assert(NoDefault::alive == 0);
+        v.PushBack(NoDefault(1));
+    }
+    assert(NoDefault::alive == 0);
+    cout << "Done!" << endl << endl;
+}
+
+struct Record {
+    Record(string name, string city, int age)
+        : name(move(name))
+        , city(move(city))
+        , age(age) {
+    }
+    Record(const Record&) = delete;
+    Record(Record&&) = default;
+    Record& operator=(const Record&) = delete;
+    Record& operator=(Record&&) = default;
+
+    string name;
+    string city;
+    int age;
+};
+
+void TestEmplace() {
+    cout << "Test emplace" << endl;
+    SimpleVector<Record> v;
+    Record& first = v.EmplaceBack("Ivan", "Moscow", 30);
+    assert(first.name == "Ivan" && first.age == 30);
+    v.EmplaceBack("Anna", "Kazan", 25);
+    auto it = v.Emplace(v.begin() + 1, "Oleg", "Omsk", 40);
+    assert(it == v.begin() + 1);
+    assert(v.GetSize() == 3);
+    assert(v[0].name == "Ivan" && v[1].name == "Oleg" && v[2].name == "Anna");
+    v.Emplace(v.end(), "Petr", "Tver", 50);
+    v.Emplace(v.begin(), "Olga", "Perm", 20);
+    assert(v.GetSize() == 5);
+    assert(v[0].city == "Perm" && v[4].city == "Tver");
+
+    SimpleVector<string> words{"alpha", "beta", "gamma"};
+    words.PushBack(words[0]);
+    words.Insert(words.begin(), words[2]);
+    words.Emplace(words.begin() + 1, words[4]);
+    assert(words.GetSize() == 6);
+    assert(words[0] == "gamma" && words[1] == "alpha" && words[5] == "alpha");
+    cout << "Done!" << endl << endl;
+}
+
+void TestRelocationStrategy() {
+    cout << "Test relocation strategy" << endl;
+    static_assert(is_nothrow_move_constructible_v<SimpleVector<int>>);
+    static_assert(is_nothrow_move_assignable_v<SimpleVector<int>>);
+    static_assert(IsTriviallyRelocatable<SimpleVector<int>>::value);
+    static_assert(IsTriviallyRelocatable<SimpleVector<SimpleVector<string>>>::value);
+    static_assert(!IsTriviallyRelocatable<::pmr::SimpleVector<int>>::value);
+    static_assert(!IsTriviallyRelocatable<SimpleVector<int, ArenaAllocator<int>>>::value);
+    {
+        SimpleVector<Tracked<true>> v(Reserve(1));
+        Tracked<true>::ResetCounters();
+        for (int i = 0; i < 16; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(Tracked<true>::copies == 0);
+        assert(Tracked<true>::moves == 15);
+        v.Resize(100);
+        assert(Tracked<true>::copies == 0);
+        assert(v[15].GetValue() == 15);
+    }
+    {
+        SimpleVector<Tracked<false>> v(Reserve(1));
+        Tracked<false>::ResetCounters();
+        for (int i = 0; i < 16; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(Tracked<false>::moves == 0);
+        assert(Tracked<false>::copies == 15);
+        assert(v[15].GetValue() == 15);
+    }
+    {
+        SimpleVector<SimpleVector<int>> nested;
+        ResetVectorStats();
+        for (int i = 0; i < 100; ++i) {
+            nested.PushBack(SimpleVector<int>(static_cast<size_t>(i), i));
+        }
+        nested.Insert(nested.begin(), SimpleVector<int>{7, 7});
+        nested.Reserve(1000);
+        // growth relocates the inner vectors with memcpy, never by moving them one by one
+        const VectorStatsSnapshot stats = VectorStatsOf<SimpleVector<int>>().Snapshot();
+        assert(stats.elements_relocated_bytewise > 0 && stats.elements_moved == 0 && stats.elements_copied == 0);
+        assert(nested.GetSize() == 101);
+        assert(nested[0] == SimpleVector<int>({7, 7}));
+        for (int i = 0; i < 100; ++i) {
+            assert(nested[i + 1] == SimpleVector<int>(static_cast<size_t>(i), i));
+        }
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestStatefulAllocator() {
+    cout << "Test stateful allocator" << endl;
+    Arena first_arena;
+    Arena second_arena;
+    {
+        using ArenaVector = SimpleVector<string, ArenaAllocator<string>>;
+        ArenaAllocator<string> first(first_arena);
+        ArenaAllocator<string> second(second_arena);
+
+        ArenaVector v(first);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(to_string(i));
+        }
+        assert(first_arena.allocations > 0);
+        assert(second_arena.allocations == 0);
+
+        ArenaVector copy(v);
+        assert(copy.GetAllocator() == first);
+        assert(copy == v);
+
+        ArenaVector other(3, "x"s, second);
+        other = v;
+        assert(other.GetAllocator() == second);
+        assert(other == v);
+
+        const size_t first_allocations = first_arena.allocations;
+        ArenaVector moved(second);
+        moved = move(copy);
+        assert(moved.GetAllocator() == second);
+        assert(moved == v);
+        assert(first_arena.allocations == first_allocations);
+
+        ArenaVector stolen(first);
+        stolen = move(v);
+        assert(stolen.GetAllocator() == first);
+        assert(stolen.GetSize() == 100 && v.IsEmpty());
+        assert(first_arena.allocations == first_allocations);
+
+        stolen.swap(v);
+        assert(v.GetSize() == 100 && stolen.IsEmpty());
+
+        ArenaVector transferred(move(v), second);
+        assert(transferred.GetAllocator() == second);
+        assert(transferred[99] == "99");
+    }
+    assert(first_arena.bytes_in_use == 0);
+    assert(second_arena.bytes_in_use == 0);
+    cout << "Done!" << endl << endl;
+}
+
+void TestSmallVector() {
+    cout << "Test small vector" << endl;
+    Arena arena;
+    {
+        using SmallVector = SmallSimpleVector<X, 4, ArenaAllocator<X>>;
+        ArenaAllocator<X> alloc(arena);
+
+        SmallVector v(alloc);
+        for (size_t i = 0; i < 4; ++i) {
+            v.PushBack(X(i));
+        }
+        assert(v.IsInline() && v.GetCapacity() == 4);
+        assert(arena.allocations == 0);
+
+        SmallVector moved(move(v));
+        assert(moved.IsInline() && moved.GetSize() == 4);
+        assert(v.IsEmpty());
+        for (size_t i = 0; i < 4; ++i) {
+            assert(moved[i].GetX() == i);
+        }
+
+        moved.Insert(moved.begin() + 1, X(10));
+        assert(!moved.IsInline() && arena.allocations == 1);
+        assert(moved[1].GetX() == 10 && moved[4].GetX() == 3);
+        moved.Erase(moved.begin());
+        assert(moved.GetSize() == 4 && moved[0].GetX() == 10);
+
+        SmallVector heap_moved(alloc);
+        heap_moved = move(moved);
+        assert(!heap_moved.IsInline() && heap_moved.GetSize() == 4);
+        assert(moved.IsInline() && moved.IsEmpty());
+        assert(arena.allocations == 1);
+
+        moved.EmplaceBack(7);
+        moved.swap(heap_moved);
+        assert(moved.GetSize() == 4 && heap_moved.GetSize() == 1);
+        assert(heap_moved.IsInline() && heap_moved[0].GetX() == 7);
+    }
+    assert(arena.bytes_in_use == 0);
+
+    SmallSimpleVector<int, 8> a{1, 2, 3};
+    SmallSimpleVector<int, 8> b(a);
+    assert(a == b);
+    b.Resize(10);
+    assert(b.GetSize() == 10 && b[9] == 0 && !b.IsInline());
+    assert(a < b && b > a && a != b);
+    b = a;
+    assert(a == b);
+    b.Reserve(20);
+    assert(b.GetCapacity() == 20 && a <= b && a >= b);
+    cout << "Done!" << endl << endl;
+}
+
+void TestGrowthPolicy() {
+    cout << "Test growth policy" << endl;
+    {
+        SimpleVector<int, allocator<int>, OneAndHalfGrowth> v;
+        size_t expected_capacity = 0;
+        for (int i = 0; i < 1000; ++i) {
+            if (v.IsFull()) {
+                expected_capacity = max(expected_capacity + expected_capacity / 2, v.GetSize() + 1);
+            }
+            v.PushBack(i);
+            assert(v.GetCapacity() == expected_capacity);
+        }
+    }
+    {
+        using Growth = SizeClassGrowth<4096, 2 * 1024 * 1024, 32 * 1024 * 1024>;
+        assert(Growth::RoundUpBytes(1) == 16);
+        assert(Growth::RoundUpBytes(129) == 160);
+        assert(Growth::RoundUpBytes(1000) == 1024);
+        assert(Growth::RoundUpBytes(5000) == 8192);
+        assert(Growth::RoundUpBytes(40 * 1024 * 1024 + 1) == 42 * 1024 * 1024);
+
+        SimpleVector<int, allocator<int>, Growth> v;
+        for (int i = 0; i < 100000; ++i) {
+            v.PushBack(i);
+            const size_t bytes = v.GetCapacity() * sizeof(int);
+            assert(Growth::RoundUpBytes(bytes) == bytes);
+        }
+        v.Resize(10 * 1024 * 1024);
+        assert(v.GetCapacity() * sizeof(int) % (2 * 1024 * 1024) == 0);
+        assert(v[99999] == 99999);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestShrinkToFit() {
+    cout << "Test shrink to fit" << endl;
+    Arena arena;
+    {
+        SimpleVector<NoDefault, ArenaAllocator<NoDefault>> v(ReserveProxyObj(1000), ArenaAllocator<NoDefault>(arena));
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(arena.bytes_in_use == 1000 * sizeof(NoDefault));
+        v.PopBack();
+        assert(NoDefault::alive == 9);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 9);
+        assert(arena.bytes_in_use == 9 * sizeof(NoDefault));
+        assert(v[8].GetValue() == 8);
+        v.Clear();
+        assert(NoDefault::alive == 0);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0 && arena.bytes_in_use == 0);
+    }
+    {
+        SimpleVector<int, allocator<int>, AutoShrink<>> v(1024, 1);
+        while (v.GetSize() > 256) {
+            v.PopBack();
+        }
+        assert(v.GetCapacity() == 1024);
+        v.PopBack();
+        assert(v.GetCapacity() == 512);
+        v.Erase(v.begin());
+        v.Resize(100);
+        assert(v.GetCapacity() == 256);
+        assert(v.GetSize() == 100 && v[99] == 1);
+    }
+    {
+        // X can only be relocated by a throwing move, which could fail halfway: never shrunk
+        SimpleVector<X, allocator<X>, AutoShrink<>> v;
+        for (size_t i = 0; i < 64; ++i) {
+            v.EmplaceBack(i);
+        }
+        while (v.GetSize() > 1) {
+            v.PopBack();
+        }
+        assert(v.GetCapacity() == 64 && v[0].GetX() == 0);
+    }
+    {
+        SmallSimpleVector<string, 2> v{"a", "b", "c"};
+        v.PopBack();
+        v.ShrinkToFit();
+        assert(v.IsInline() && v.GetSize() == 2 && v[1] == "b");
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestRangeOperations() {
+    cout << "Test range operations" << endl;
+    {
+        list<int> values{1, 2, 3, 4};
+        SimpleVector<int> v(values.begin(), values.end());
+        assert(v == SimpleVector<int>({1, 2, 3, 4}));
+        assert(v.GetCapacity() == 4);
+
+        istringstream input("5 6 7");
+        v.Append(istream_iterator<int>(input), istream_iterator<int>());
+        assert(v == SimpleVector<int>({1, 2, 3, 4, 5, 6, 7}));
+
+        v.Append(v.begin(), v.end());
+        assert(v.GetSize() == 14 && v[7] == 1 && v[13] == 7);
+
+        SimpleVector<int> from_list(from_range, values);
+        assert(from_list == SimpleVector<int>({1, 2, 3, 4}));
+
+        v.InsertRange(v.begin() + 1, values.begin(), values.end());
+        assert(v.GetSize() == 18 && v[0] == 1 && v[1] == 1 && v[4] == 4 && v[5] == 2);
+
+        v.EraseRange(v.begin() + 1, v.begin() + 5);
+        assert(v.GetSize() == 14);
+        assert(v.EraseIf([](int x) { return x % 2 == 0; }) == 6);
+        assert(v == SimpleVector<int>({1, 3, 5, 7, 1, 3, 5, 7}));
+    }
+    {
+        SimpleVector<string> v(ReserveProxyObj(20));
+        v.Append(SimpleVector<string>{"a", "b", "c", "d", "e"});
+        SimpleVector<string> short_range{"x", "y"};
+        v.InsertRange(v.begin() + 1, short_range.begin(), short_range.end());
+        assert(v == SimpleVector<string>({"a", "x", "y", "b", "c", "d", "e"}));
+        SimpleVector<string> long_range{"1", "2", "3", "4"};
+        v.InsertRange(v.end() - 2, long_range.begin(), long_range.end());
+        assert(v == SimpleVector<string>({"a", "x", "y", "b", "c", "1", "2", "3", "4", "d", "e"}));
+        istringstream input("p q");
+        v.InsertRange(v.begin(), istream_iterator<string>(input), istream_iterator<string>());
+        assert(v[0] == "p" && v[1] == "q" && v[2] == "a" && v.GetSize() == 13);
+        v.EraseRange(v.begin(), v.end());
+        assert(v.IsEmpty());
+    }
+    {
+        SimpleVector<SimpleVector<int>> nested(ReserveProxyObj(10));
+        nested.PushBack({1});
+        nested.PushBack({4});
+        SimpleVector<SimpleVector<int>> middle{{2}, {3, 3}};
+        nested.InsertRange(nested.begin() + 1, middle.begin(), middle.end());
+        assert(nested.GetSize() == 4 && nested[2] == SimpleVector<int>({3, 3}) && nested[3][0] == 4);
+        nested.EraseRange(nested.begin(), nested.begin() + 2);
+        assert(nested.GetSize() == 2 && nested[0][1] == 3);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+class CollectingExporter : public VectorStatsExporter {
+public:
+    void Export(string_view scope, const VectorStatsSnapshot& stats) override {
+        exported[string(scope)] = stats;
+    }
+
+    map<string, VectorStatsSnapshot> exported;
+};
+
+void TestInstrumentation() {
+    cout << "Test instrumentation" << endl;
+    ResetVectorStats();
+    {
+        SimpleVector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        v.Insert(v.begin() + 90, 0);
+        v.Erase(v.begin());
+    }
+    {
+        SimpleVector<string> v(ReserveProxyObj(1));
+        v.PushBack("a");
+        v.PushBack("b");
+    }
+    CollectingExporter exporter;
+    ExportVectorStats(exporter);
+
+    const VectorStatsSnapshot& ints = exporter.exported.at("int");
+    assert(ints.allocations == 8 && ints.deallocations == 8);
+    assert(ints.reallocations == 8);
+    assert(ints.elements_relocated_bytewise == 127);
+    assert(ints.bytes_relocated == 127 * sizeof(int));
+    assert(ints.peak_capacity_bytes == 128 * sizeof(int));
+    assert(ints.insert_shifts == 2);
+    assert(ints.elements_shifted == 10 + 100);
+
+    const VectorStatsSnapshot& strings = exporter.exported.at(VectorTypeName<string>());
+    assert(strings.allocations == 2 && strings.elements_moved == 1);
+
+    const VectorStatsSnapshot& global = exporter.exported.at("global");
+    assert(global.allocations == ints.allocations + strings.allocations);
+    cout << "Done!" << endl << endl;
+}
+
+void TestComparisonKernels() {
+    cout << "Test comparison and search kernels" << endl;
+    {
+        // lengths around the vector width exercise both the SIMD blocks and the scalar tail
+        for (size_t size : {0, 1, 7, 8, 31, 32, 33, 100}) {
+            SimpleVector<int> lhs(size);
+            iota(lhs.begin(), lhs.end(), -50);
+            SimpleVector<int> rhs = lhs;
+            assert(lhs == rhs && (lhs <=> rhs) == 0);
+            for (size_t i = 0; i < size; ++i) {
+                rhs[i] += 1;
+                assert(lhs != rhs && lhs < rhs && rhs > lhs);
+                assert(vector_kernels::Mismatch(lhs.cbegin(), rhs.cbegin(), size) == i);
+                rhs[i] -= 1;
+            }
+            rhs.PushBack(0);
+            assert(lhs != rhs && lhs < rhs);
+        }
+    }
+    {
+        SimpleVector<uint8_t> lhs{1, 200, 3};
+        SimpleVector<uint8_t> rhs{1, 100, 3, 4};
+        assert(lhs > rhs && rhs < lhs && (lhs <=> lhs) == 0);
+    }
+    {
+        SimpleVector<float> lhs(40, 1.0f);
+        SimpleVector<float> rhs = lhs;
+        lhs[5] = 0.0f;
+        rhs[5] = -0.0f;
+        assert(lhs == rhs);
+        rhs[39] = NAN;
+        assert(lhs != rhs);
+        assert(!(lhs < rhs) && !(lhs > rhs) && (lhs <=> rhs) == partial_ordering::unordered);
+    }
+    {
+        SimpleVector<int> v(1000);
+        iota(v.begin(), v.end(), 0);
+        v[600] = 7;
+        assert(vector_kernels::Find(v, 7) == 7);
+        assert(vector_kernels::Find(v, 999) == 999);
+        assert(vector_kernels::Find(v, -1) == v.GetSize());
+        assert(vector_kernels::Count(v, 7) == 2);
+        assert(vector_kernels::Min(v) == 0 && vector_kernels::Max(v) == 999);
+        assert(vector_kernels::Sum(v) == accumulate(v.begin(), v.end(), 0));
+
+        SimpleVector<double> d{3.5, -2.0, 8.25, 1.0, 0.5, 4.0, -7.75, 2.0, 6.0};
+        assert(vector_kernels::Min(d) == -7.75 && vector_kernels::Max(d) == 8.25);
+        assert(vector_kernels::Sum(d) == 15.5);
+
+        SmallSimpleVector<uint16_t, 4> small{5, 1, 5, 2, 5, 3, 5, 4, 5, 6, 5, 7, 5, 8, 5, 9, 5};
+        assert(vector_kernels::Count(small, uint16_t{5}) == 9 && vector_kernels::Max(small) == 9);
+        assert(small == small && !(small < small));
+    }
+    {
+        SimpleVector<string> lhs{"a", "b"};
+        SimpleVector<string> rhs{"a", "c"};
+        assert(lhs < rhs && vector_kernels::Find(rhs, string("c")) == 1);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestParallelAlgorithms() {
+    cout << "Test parallel algorithms" << endl;
+    ThreadPool pool(4);
+    const size_t size = 1'000'003;
+    {
+        SimpleVector<int> zeros(pool, size);
+        assert(zeros.GetSize() == size && all_of(zeros.begin(), zeros.end(), [](int x) { return x == 0; }));
+        SimpleVector<int> sevens(pool, size, 7);
+        assert(sevens.GetCapacity() == size && all_of(sevens.begin(), sevens.end(), [](int x) { return x == 7; }));
+        SimpleVector<string> strings(pool, 10, "abc"s);
+        assert(strings.GetSize() == 10 && strings[9] == "abc");
+    }
+    {
+        ThrowingCounter::throw_at = 500'000;
+        try {
+            SimpleVector<ThrowingCounter> v(pool, size);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        assert(ThrowingCounter::alive == 0);
+    }
+    {
+        SimpleVector<int> v(pool, size);
+        iota(v.begin(), v.end(), 0);
+        ParallelForEach(v, [](int& x) { x *= 2; }, pool);
+        assert(v[size - 1] == static_cast<int>(2 * (size - 1)));
+        ParallelTransform(v, v, [](int x) { return x / 2; }, pool);
+        for (size_t i = 0; i < size; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+
+        const long long sum = ParallelReduce(v, 0LL, plus<>(), pool);
+        assert(sum == static_cast<long long>(size) * (size - 1) / 2);
+        const string digits = ParallelReduce(SimpleVector<string>(1000, "x"s), string(), plus<>(), pool);
+        assert(digits == string(1000, 'x'));
+
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<int>((i * 7919) % 100'003);
+        }
+        ParallelSort(v, less<>(), pool);
+        assert(is_sorted(v.begin(), v.end()));
+        ParallelSort(v, greater<>(), pool);
+        assert(is_sorted(v.begin(), v.end(), greater<>()));
+    }
+    {
+        SimpleVector<int> v(size, 1);
+        bool thrown = false;
+        try {
+            ParallelForEach(v, [](int& x) {
+                if (x == 1) {
+                    throw logic_error("stop");
+                }
+            }, pool);
+        } catch (const logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestConcurrentVector() {
+    cout << "Test concurrent vector" << endl;
+    {
+        const int threads = 4;
+        const int per_thread = 20'000;
+        ConcurrentSimpleVector<int> shared;
+        int& first = shared.PushBack(-1);
+        vector<thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&shared, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    shared.PushBack(t * per_thread + i);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        assert(shared.GetSize() == threads * per_thread + 1);
+        assert(&shared[0] == &first && first == -1);
+
+        SimpleVector<int> frozen = shared.Freeze();
+        assert(shared.IsEmpty() && frozen.GetSize() == threads * per_thread + 1);
+        std::sort(frozen.begin(), frozen.end());
+        for (int i = 0; i <= threads * per_thread; ++i) {
+            assert(frozen[i] == i - 1);
+        }
+    }
+    {
+        ConcurrentSimpleVector<string> names(100);
+        for (int i = 0; i < 100; ++i) {
+            names.EmplaceBack(to_string(i).c_str());
+        }
+        const string* data = &names[0];
+        SimpleVector<string> frozen = names.Freeze();
+        assert(frozen.begin() == data && frozen.GetCapacity() == 128);
+        assert(frozen[99] == "99");
+        frozen.PushBack("100"s);
+        assert(frozen.GetSize() == 101);
+    }
+    {
+        ConcurrentSimpleVector<Record> records;
+        for (int i = 0; i < 1000; ++i) {
+            records.EmplaceBack("name"s, "city"s, i);
+        }
+        SimpleVector<Record> frozen = records.Freeze();
+        assert(frozen.GetSize() == 1000 && frozen.GetCapacity() == 1000 && frozen[999].age == 999);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestBufferPool() {
+    cout << "Test buffer pool" << endl;
+    BufferPool& pool = BufferPool::Instance();
+    pool.Trim();
+    {
+        const int* first_buffer = nullptr;
+        {
+            PooledSimpleVector<int> v(100, 1);
+            first_buffer = v.begin();
+        }
+        const BufferPoolStats before = pool.GetStats();
+        PooledSimpleVector<int> reused(Reserve(120));
+        // 100 and 120 ints share the 512-byte size class
+        assert(reused.begin() == first_buffer);
+        assert(pool.GetStats().thread_hits == before.thread_hits + 1);
+        assert(pool.GetStats().system_allocations == before.system_allocations);
+
+        for (int i = 0; i < 1000; ++i) {
+            reused.PushBack(i);
+        }
+        const BufferPoolStats grown = pool.GetStats();
+        PooledSimpleVector<int> again;
+        for (int i = 0; i < 1000; ++i) {
+            again.PushBack(i);
+        }
+        // the 512..4096 byte buffers the first vector grew through are recycled by the second one
+        assert(pool.GetStats().thread_hits >= grown.thread_hits + 4);
+
+        // another thread's hits are counted once it exits
+        const uint64_t hits = pool.GetStats().thread_hits;
+        thread([] {
+            PooledSimpleVector<int>(10, 1);
+            PooledSimpleVector<int>(10, 2);
+        }).join();
+        assert(pool.GetStats().thread_hits == hits + 1);
+    }
+    {
+        const BufferPoolLimits defaults = pool.GetLimits();
+        pool.SetLimits({0, 1 << 20});
+        PooledSimpleVector<double>* shared = new PooledSimpleVector<double>(1000, 0.5);
+        thread([shared] {
+            delete shared;
+        }).join();
+        const BufferPoolStats before = pool.GetStats();
+        PooledSimpleVector<double> v(1000, 0.25);
+        assert(pool.GetStats().global_hits == before.global_hits + 1);
+
+        pool.SetLimits({0, 0});
+        const uint64_t deallocations = pool.GetStats().system_deallocations;
+        v = PooledSimpleVector<double>();
+        assert(pool.GetStats().system_deallocations == deallocations + 1);
+        pool.SetLimits(defaults);
+    }
+    {
+        PooledSimpleVector<int> large(1 << 20);
+        using Wide = SimpleVector<int, PooledAllocator<int>>;
+        static_assert(is_same_v<PooledSimpleVector<int>, Wide>);
+        assert(large.GetSize() == 1 << 20);
+    }
+    pool.Trim();
+    cout << "Done!" << endl << endl;
+}
+
+void TestMappedVector() {
+    cout << "Test mapped vector" << endl;
+    char path[] = "/tmp/simple_vector_test_XXXXXX";
+    const int fd = mkstemp(path);
+    assert(fd >= 0);
+    {
+        SimpleVector<Point> points;
+        for (int i = 0; i < 10'000; ++i) {
+            points.PushBack({i, i * 0.5});
+        }
+        Save(fd, points);
+
+        MappedSimpleVector<Point> mapped(path);
+        assert(mapped.GetSize() == points.GetSize() && mapped.Verify());
+        assert(mapped[9'999].x == 9'999 && mapped.At(10).y == 5.0);
+        assert(reinterpret_cast<uintptr_t>(mapped.begin()) % alignof(Point) == 0);
+        assert(equal(mapped.begin(), mapped.end(), points.begin(), [](const Point& lhs, const Point& rhs) {
+            return lhs.x == rhs.x && lhs.y == rhs.y;
+        }));
+        try {
+            mapped.At(10'000);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+
+        MappedSimpleVector<Point> moved(move(mapped));
+        assert(moved.GetSize() == 10'000 && mapped.IsEmpty());
+
+        try {
+            MappedSimpleVector<int> wrong_type(path);
+            assert(false);
+        } catch (const VectorFormatError&) {
+        }
+    }
+    {
+        const SimpleVector<uint32_t> values{1, 2, 3, 4, 5};
+        stringstream stream;
+        Save(stream, values);
+        const SimpleVector<uint32_t> loaded = LoadSimpleVector<uint32_t>(stream);
+        assert(loaded == values && loaded.GetCapacity() == values.GetSize());
+
+        string bytes = stream.str();
+        bytes[bytes.size() - 1] ^= 1;
+        istringstream corrupt(bytes);
+        try {
+            LoadSimpleVector<uint32_t>(corrupt);
+            assert(false);
+        } catch (const VectorFormatError&) {
+        }
+        istringstream truncated(bytes.substr(0, bytes.size() - 2));
+        try {
+            LoadSimpleVector<uint32_t>(truncated);
+            assert(false);
+        } catch (const VectorFormatError&) {
+        }
+
+        // a snapshot cut short fails cleanly, before allocating for the count in its header
+        assert(ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0);
+        Save(fd, SimpleVector<uint32_t>(1000, 7));
+        assert(lseek(fd, 0, SEEK_SET) == 0 && LoadSimpleVector<uint32_t>(fd) == SimpleVector<uint32_t>(1000, 7));
+        ResetVectorStats();
+        for (uint64_t count : {uint64_t{1000}, uint64_t{1} << 40}) {
+            VectorFileHeader header;
+            assert(pread(fd, &header, sizeof(header), 0) == sizeof(header));
+            header.count = count;
+            assert(pwrite(fd, &header, sizeof(header), 0) == sizeof(header));
+            assert(ftruncate(fd, 4000) == 0 && lseek(fd, 0, SEEK_SET) == 0);
+            try {
+                LoadSimpleVector<uint32_t>(fd);
+                assert(false);
+            } catch (const VectorFormatError&) {
+            }
+        }
+        assert(VectorStatsOf<uint32_t>().Snapshot().allocations == 0);
+
+        assert(ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0);
+        Save(fd, SimpleVector<uint32_t>());
+        assert(MappedSimpleVector<uint32_t>(fd).IsEmpty());
+    }
+    close(fd);
+    unlink(path);
+    cout << "Done!" << endl << endl;
+}
+
+int SumOf(SimpleVectorView<const int> values) {
+    return accumulate(values.begin(), values.end(), 0);
+}
+
+void TestVectorView() {
+    cout << "Test vector view" << endl;
+    {
+        SimpleVector<int> v{1, 2, 3, 4, 5, 6};
+        assert(SumOf(v) == 21);
+
+        SimpleVectorView<int> all = v;
+        assert(all.GetSize() == 6 && all.Data() == v.begin());
+        all[0] = 10;
+        assert(v[0] == 10);
+
+        const auto middle = all.Subview(1, 3);
+        assert(middle.GetSize() == 3 && middle[0] == 2 && middle.At(2) == 4);
+        assert(all.Subview(4).GetSize() == 2 && all.Subview(6).IsEmpty());
+        assert(all.First(2) == SimpleVector<int>({10, 2}));
+        assert(all.Last(2) == SimpleVector<int>({5, 6}));
+        assert(all.First(0).IsEmpty() && all.Last(6) == all);
+
+        try {
+            middle.At(3);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        try {
+            all.Subview(7);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        try {
+            all.Last(7);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        SimpleVector<int> v{1, 2, 3};
+        SimpleVectorView<const int> view = v;
+        assert(view == v && v == view);
+        assert(view < SimpleVector<int>({1, 2, 4}) && view > view.First(2));
+        assert((view <=> view.Subview(1)) < 0);
+        SimpleVectorView deduced = v;
+        static_assert(is_same_v<decltype(deduced), SimpleVectorView<int>>);
+        const SimpleVector<int>& const_ref = v;
+        SimpleVectorView deduced_const = const_ref;
+        static_assert(is_same_v<decltype(deduced_const), SimpleVectorView<const int>>);
+        static_assert(!is_constructible_v<SimpleVectorView<int>, SimpleVector<int>&&>);
+        static_assert(is_constructible_v<SimpleVectorView<const int>, SimpleVector<int>&&>);
+        static_assert(!is_constructible_v<SimpleVectorView<int>, const SimpleVector<int>&>);
+        static_assert(is_trivially_copyable_v<SimpleVectorView<int>>);
+
+        SmallSimpleVector<int, 4> small{1, 2, 3};
+        assert(SimpleVectorView<const int>(small) == view);
+        vector<int> standard{1, 2, 3};
+        assert(SimpleVectorView<const int>(standard) == view);
+
+        ArrayPtr<int> storage(3, uninitialized);
+        uninitialized_copy(v.begin(), v.end(), storage.GetRawPtr());
+        assert(SimpleVectorView<const int>(storage, 3) == view);
+
+        SimpleVectorView<const float> floats;
+        assert(floats.IsEmpty() && floats == floats);
+        assert(vector_kernels::Sum(view.Subview(1)) == 5);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestCowVector() {
+    cout << "Test copy-on-write vector" << endl;
+    static_assert(sizeof(CowSimpleVector<int>) == sizeof(void*));
+    {
+        CowSimpleVector<int> original{1, 2, 3};
+        CowSimpleVector<int> snapshot = original;
+        assert(original.UseCount() == 2 && snapshot.IsShared());
+        assert(snapshot.cbegin() == original.cbegin());
+        assert(snapshot == original && snapshot[2] == 3);
+
+        original.PushBack(4);
+        assert(!original.IsShared() && !snapshot.IsShared());
+        assert(snapshot.GetSize() == 3 && original.GetSize() == 4);
+        assert(snapshot.View() == SimpleVector<int>({1, 2, 3}));
+
+        CowSimpleVector<int> reader = snapshot;
+        const int* shared_data = reader.cbegin();
+        reader[0] = 10;
+        assert(reader.cbegin() != shared_data && snapshot.cbegin() == shared_data);
+        assert(snapshot[0] == 1 && reader[0] == 10 && !(reader < snapshot));
+
+        CowSimpleVector<int> writer = snapshot;
+        auto pos = writer.Insert(writer.cbegin() + 1, 7);
+        assert(*pos == 7 && writer.GetSize() == 4 && snapshot.GetSize() == 3);
+        writer = snapshot;
+        writer.Erase(writer.cbegin());
+        assert(writer.View() == SimpleVector<int>({2, 3}) && snapshot[0] == 1);
+        writer = snapshot;
+        writer.Resize(10);
+        assert(writer.GetSize() == 10 && snapshot.GetSize() == 3);
+
+        // the last owner mutates in place
+        const int* unique_data = writer.cbegin();
+        writer[9] = 9;
+        assert(writer.cbegin() == unique_data);
+    }
+    {
+        CowSimpleVector<string> empty;
+        assert(empty.IsEmpty() && empty.UseCount() == 0 && empty.begin() == empty.end());
+        CowSimpleVector<string> copy = empty;
+        copy.EmplaceBack(3, 'x');
+        assert(empty.IsEmpty() && copy[0] == "xxx");
+
+        SimpleVector<string> source{"a", "b"};
+        const string* data = source.begin();
+        CowSimpleVector<string> adopted(move(source));
+        assert(adopted.cbegin() == data && adopted.GetSize() == 2);
+        copy = adopted;
+        adopted.Clear();
+        assert(adopted.IsEmpty() && copy.GetSize() == 2 && !copy.IsShared());
+    }
+    {
+        CowSimpleVector<int> published(1000, 1);
+        vector<thread> readers;
+        atomic<long> total = 0;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([published, &total]() mutable {
+                CowSimpleVector<int> local = published;
+                local.PushBack(1);
+                total += accumulate(local.cbegin(), local.cend(), 0L);
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        assert(total == 4 * 1001 && published.UseCount() == 1 && published.GetSize() == 1000);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestSoAVector() {
+    cout << "Test structure-of-arrays vector" << endl;
+    {
+        SoASimpleVector<int, double, string> rows;
+        assert(rows.IsEmpty());
+        rows.PushBack({1, 0.5, "one"});
+        rows.EmplaceBack(2, 1.5, "two");
+        for (int i = 3; i <= 100; ++i) {
+            rows.EmplaceBack(i, i + 0.5, to_string(i));
+        }
+        assert(rows.GetSize() == 100 && rows.GetCapacity() >= 100);
+
+        // each column is contiguous
+        SimpleVectorView<int> ids = rows.Column<0>();
+        assert(ids.GetSize() == 100 && ids[99] == 100);
+        assert(accumulate(ids.begin(), ids.end(), 0) == 5050);
+        const auto& const_rows = rows;
+        SimpleVectorView<const string> names = const_rows.Column<2>();
+        assert(names[0] == "one" && names[1] == "two" && names[99] == "100");
+
+        auto [id, weight, name] = rows[4];
+        assert(id == 5 && weight == 5.5 && name == "5");
+        id = 50;
+        name += "!";
+        assert(rows.Column<0>()[4] == 50 && rows.Column<2>()[4] == "5!");
+        rows[4] = tuple(5, 0.0, "five"s);
+        assert(rows[4] == tuple(5, 0.0, "five"s));
+        const tuple<int, double, string> copy = const_rows.At(4);
+        assert(get<2>(copy) == "five" && const_rows[4].Get<1>() == 0.0);
+
+        rows.Erase(0);
+        assert(rows.GetSize() == 99 && rows[0].Get<2>() == "two" && rows.Column<0>()[98] == 100);
+        rows.PopBack();
+        assert(rows.GetSize() == 98);
+
+        // the new row may be built from a row of the same vector while it reallocates
+        rows.ShrinkToFit();
+        assert(rows.GetCapacity() == rows.GetSize());
+        rows.EmplaceBack(rows[0].Get<0>(), rows[0].Get<1>(), rows[0].Get<2>());
+        assert(rows[98] == tuple(2, 1.5, "two"s));
+
+        SoASimpleVector<int, double, string> other = rows;
+        assert(other.GetSize() == 99 && other[97] == rows[97]);
+        other.Clear();
+        assert(other.IsEmpty() && rows.GetSize() == 99);
+        other = move(rows);
+        assert(other.GetSize() == 99 && rows.IsEmpty());
+
+        try {
+            other.At(99);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        SoASimpleVector<int, string> rows(3);
+        assert(rows[2] == tuple(0, ""s));
+        rows.Reserve(50);
+        const int* ids = rows.Column<0>().Data();
+        rows.Resize(50);
+        assert(rows.Column<0>().Data() == ids && rows.GetCapacity() == 50);
+        rows.Resize(1);
+        assert(rows.GetSize() == 1 && rows.Column<1>().GetSize() == 1);
+    }
+    {
+        // a column throwing while rows are built leaves no fields of other columns behind
+        SoASimpleVector<string, FlakyField> rows(2);
+        FlakyField::budget = 3;
+        try {
+            rows.Resize(10);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FlakyField::budget = -1;
+        assert(rows.GetSize() == 2 && FlakyField::alive == 2);
+        FlakyField::budget = 1;
+        try {
+            rows.EmplaceBack("x", FlakyField());
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FlakyField::budget = -1;
+        assert(rows.GetSize() == 2 && FlakyField::alive == 2);
+    }
+    assert(FlakyField::alive == 0);
+    {
+        // a throwing copy of the second column must not leave the first one moved from
+        SoASimpleVector<string, FlakyCopy> rows;
+        rows.Reserve(3);
+        for (int i = 0; i < 3; ++i) {
+            rows.EmplaceBack(string(32, static_cast<char>('a' + i)), FlakyCopy());
+        }
+        const string* names = rows.Column<0>().Data();
+        FlakyCopy::budget = 2;
+        try {
+            rows.Reserve(100);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FlakyCopy::budget = -1;
+        assert(rows.GetSize() == 3 && rows.GetCapacity() == 3 && rows.Column<0>().Data() == names);
+        for (int i = 0; i < 3; ++i) {
+            assert(rows[i].Get<0>() == string(32, static_cast<char>('a' + i)));
+        }
+        rows.Reserve(100);
+        assert(rows.GetCapacity() == 100 && rows[2].Get<0>() == string(32, 'c'));
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestSegmentedVector() {
+    cout << "Test segmented vector" << endl;
+    {
+        using Segmented = SegmentedSimpleVector<string, allocator<string>, 1024>;
+        static_assert(ranges::random_access_range<Segmented>);
+        static_assert(Segmented::kBlockSize == 1024 / sizeof(string));
+        ResetVectorStats();
+        Segmented v;
+        v.PushBack("first");
+        const string* first = &v[0];
+        const size_t count = Segmented::kBlockSize * 100 + 3;
+        for (size_t i = 1; i < count; ++i) {
+            v.EmplaceBack(to_string(i));
+        }
+        // growing adds blocks and never touches the elements already stored
+        const VectorStatsSnapshot stats = VectorStatsOf<string>().Snapshot();
+        assert(&v[0] == first && stats.elements_moved == 0 && stats.elements_copied == 0);
+        assert(stats.allocations == 101 && stats.peak_capacity_bytes == Segmented::kBlockSize * sizeof(string));
+        assert(v.GetSize() == count && v.GetCapacity() == 101 * Segmented::kBlockSize && v.GetBlockCount() == 101);
+        assert(v[count - 1] == to_string(count - 1) && v.At(500) == "500");
+        assert(v.Block(100).GetSize() == 3 && v.Block(1)[0] == to_string(Segmented::kBlockSize));
+
+        v.EmplaceBack(v[0]);
+        assert(v[count] == "first");
+        auto pos = v.Insert(v.begin() + 1, "second");
+        assert(*pos == "second" && v[2] == "1" && v.GetSize() == count + 2);
+        pos = v.Erase(v.cbegin());
+        assert(*pos == "second" && v[0] == "second");
+        assert(v.EraseIf([](const string& s) { return s.size() > 2; }) > 0);
+        assert(all_of(v.begin(), v.end(), [](const string& s) { return s.size() <= 2; }));
+
+        Segmented copy = v;
+        assert(copy == v && !(copy < v));
+        copy.PopBack();
+        assert(copy < v && copy != v);
+        copy.Clear();
+        assert(copy.IsEmpty() && copy.GetCapacity() > 0);
+        copy.ShrinkToFit();
+        assert(copy.GetCapacity() == 0);
+        const size_t size = v.GetSize();
+        copy = move(v);
+        assert(v.IsEmpty() && copy.GetSize() == size);
+
+        try {
+            copy.At(size);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        SegmentedSimpleVector<int, allocator<int>, 64> v(40, 7);
+        assert(v.GetBlockCount() == 3 && accumulate(v.begin(), v.end(), 0) == 280);
+        v.Resize(100);
+        assert(v[99] == 0 && v[39] == 7);
+        sort(v.begin(), v.end());
+        assert(v[0] == 0 && v[99] == 7 && is_sorted(v.cbegin(), v.cend()));
+        v.Reserve(1000);
+        assert(v.GetCapacity() == 1008 && v.GetSize() == 100);
+        v.Resize(10);
+        assert(v.GetSize() == 10);
+    }
+    {
+        SegmentedSimpleVector<FlakyField, allocator<FlakyField>, 64> v(10);
+        FlakyField::budget = 70;
+        try {
+            v.Resize(200);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        FlakyField::budget = -1;
+        assert(v.GetSize() == 10 && FlakyField::alive == 10);
+    }
+    assert(FlakyField::alive == 0);
+    cout << "Done!" << endl << endl;
+}
+
+void TestLargePageAllocator() {
+    cout << "Test large page allocator" << endl;
+    const size_t count = (4 << 20) / sizeof(double);
+    {
+        LargePageSimpleVector<double> v(Reserve(count), LargePageAllocator<double>());
+        assert(reinterpret_cast<uintptr_t>(v.begin()) % large_pages::k2MiB == 0);
+        v.Resize(count);
+        assert(v[count - 1] == 0.0);
+        fill(v.begin(), v.end(), 1.0);
+        assert(accumulate(v.begin(), v.end(), 0.0) == static_cast<double>(count));
+    }
+    {
+        // explicit huge pages fall back to transparent ones when none are reserved
+        LargePageOptions options;
+        options.huge_pages = HugePages::k1GiB;
+        options.numa = NumaPolicy::kInterleave;
+        options.prefault = true;
+        LargePageSimpleVector<double> v(Reserve(count), LargePageAllocator<double>(options));
+        v.Resize(count);
+        fill(v.begin(), v.end(), 2.0);
+        assert(v[0] == 2.0 && v[count - 1] == 2.0 && v.GetAllocator().GetOptions() == options);
+        // without gigantic pages the mapping is 2 MiB granular, not a whole gigabyte
+        LargePageAllocator<char> gigantic(options);
+        char* block = gigantic.allocate(3 << 20);
+        if (large_pages::IsFallbackMapping(block, options)) {
+            assert(reinterpret_cast<uintptr_t>(block) % large_pages::k2MiB == 0);
+            assert(large_pages::MappingPage(block, options) == large_pages::k2MiB);
+        }
+        block[(3 << 20) - 1] = 1;
+        gigantic.deallocate(block, 3 << 20);
+
+        options.huge_pages = HugePages::kNone;
+        options.numa = NumaPolicy::kBind;
+        options.numa_node = 0;
+        LargePageSimpleVector<int> bound(Reserve(1 << 20), LargePageAllocator<int>(options));
+        bound.PushBack(1);
+        assert(bound[0] == 1 && reinterpret_cast<uintptr_t>(bound.begin()) % large_pages::kSmallPage == 0);
+
+        // small vectors grow through operator new until they reach min_bytes
+        LargePageSimpleVector<int> small{LargePageAllocator<int>(options)};
+        for (int i = 0; i < 1'000'000; ++i) {
+            small.PushBack(i);
+        }
+        assert(small[999'999] == 999'999);
+        small = bound;
+        assert(small.GetSize() == 1 && small.GetAllocator() == bound.GetAllocator());
+
+        options.numa_node = -1;
+        try {
+            LargePageSimpleVector<int> invalid(Reserve(1 << 20), LargePageAllocator<int>(options));
+            assert(false);
+        } catch (const system_error&) {
+        }
+    }
+    cout << "Done!" << endl << endl;
+}
+
+constexpr StaticSimpleVector<int, 16> MakeSquares(int count) {
+    StaticSimpleVector<int, 16> squares;
+    for (int i = 0; i < count; ++i) {
+        squares.PushBack(i * i);
+    }
+    return squares;
+}
+
+constexpr size_t StaticStringOps() {
+    StaticSimpleVector<string, 4> words{"b", "d"};
+    words.Insert(words.begin(), "a");
+    words.Insert(words.begin() + 2, "c");
+    words.Erase(words.begin() + 1);
+    StaticSimpleVector<string, 4> copy = words;
+    copy.swap(words);
+    words.PopBack();
+    return copy.GetSize() * 10 + words.GetSize();
+}
+
+void TestStaticVector() {
+    cout << "Test static vector" << endl;
+    {
+        constexpr auto squares = MakeSquares(10);
+        static_assert(squares.GetSize() == 10 && squares[9] == 81 && squares.GetCapacity() == 16);
+        static_assert(MakeSquares(3) < MakeSquares(4) && MakeSquares(4) == MakeSquares(4));
+        static_assert(StaticStringOps() == 32);
+        static_assert(is_trivially_copyable_v<StaticSimpleVector<int, 8>>);
+        static_assert(!is_trivially_copyable_v<StaticSimpleVector<string, 8>>);
+        static_assert(sizeof(StaticSimpleVector<char, 8>) == 2 * sizeof(size_t));
+
+        auto copy = squares;
+        copy.EraseIf([](int x) { return x % 2 == 1; });
+        assert(copy.GetSize() == 5 && copy[4] == 64 && copy > squares);
+    }
+    {
+        StaticSimpleVector<string, 3> v(2, "x");
+        v.EmplaceBack(3, 'y');
+        assert(v.IsFull() && v[2] == "yyy");
+        try {
+            v.PushBack("z");
+            assert(false);
+        } catch (const length_error&) {
+        }
+        try {
+            v.At(3);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        v.Erase(v.begin());
+        v.Insert(v.begin(), v[1]);
+        assert(v[0] == "yyy" && v[1] == "x" && v[2] == "yyy");
+
+        StaticSimpleVector<string, 3> other = move(v);
+        StaticSimpleVector<string, 3> small{"a"};
+        small.swap(other);
+        assert(small.GetSize() == 3 && other.GetSize() == 1 && other[0] == "a");
+        other = small;
+        assert(other == small);
+        other.Resize(1);
+        small = move(other);
+        assert(small.GetSize() == 1 && small[0] == "yyy");
+    }
+    cout << "Done!" << endl << endl;
+}
+
+template <typename Vector>
+concept CanAppendUninitialized = requires(Vector& v) { v.AppendUninitialized(1); };
+
+void TestUncheckedAppend() {
+    cout << "Test unchecked append" << endl;
+    {
+        SimpleVector<int> v = GenerateVector(1000);
+        assert(v.GetSize() == 1000 && v[0] == 1 && v[999] == 1000);
+        int* tail = v.AppendUninitialized(24);
+        assert(tail == v.begin() + 1000 && v.GetSize() == 1024);
+        fill(tail, v.end(), -1);
+        assert(v[1023] == -1);
+        assert(v.ResizeUninitialized(10) == v.begin() && v.GetSize() == 10 && v[9] == 10);
+    }
+    {
+        SimpleVector<string> v(Reserve(100));
+        for (int i = 0; i < 99; ++i) {
+            v.PushBackUnchecked(to_string(i));
+        }
+        string& last = v.EmplaceBackUnchecked(2, 'x');
+        assert(v.IsFull() && &last == &v[99] && last == "xx" && v[98] == "98");
+    }
+    static_assert(CanAppendUninitialized<SimpleVector<double>> && !CanAppendUninitialized<SimpleVector<string>>);
+    cout << "Done!" << endl << endl;
+}
+
+void TestBitVector() {
+    cout << "Test bit vector" << endl;
+    {
+        SimpleBitVector<> bits;
+        for (size_t i = 0; i < 200; ++i) {
+            bits.PushBack(i % 3 == 0);
+        }
+        assert(bits.GetSize() == 200 && bits.GetCapacity() >= 200 && bits.Words().GetSize() == 4);
+        assert(bits.Count() == 67 && bits[0] && !bits[1] && bits[198]);
+        assert(bits.FindFirst() == 0 && bits.FindNext(1) == 3 && bits.FindNext(199) == SimpleBitVector<>::npos);
+
+        bits[1] = true;
+        bits[0] = bits[2];
+        bits.Flip(2);
+        assert(!bits[0] && bits[1] && bits[2] && bits.At(3));
+        size_t visited = 0;
+        bits.ForEachSet([&](size_t index) {
+            assert(bits[index]);
+            ++visited;
+        });
+        assert(visited == bits.Count());
+
+        bits.FlipAll();
+        assert(bits.Count() == 200 - visited && bits.FindFirst() == 0);
+        try {
+            bits.At(200);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        // word-level appends at unaligned offsets
+        SimpleBitVector<> bits;
+        bits.PushBackWord(0b101, 3);
+        bits.PushBackWord(~uint64_t{0});
+        bits.PushBackWord(0xF0, 8);
+        assert(bits.GetSize() == 75 && bits.Count() == 2 + 64 + 4);
+        assert(bits[0] && !bits[1] && bits[2] && bits[3] && bits[66] && !bits[67] && bits[71] && !bits[70]);
+
+        bits.Resize(130, true);
+        assert(bits.Count() == 70 + 55 && bits[129] && bits.Words()[2] == (uint64_t{1} << 2) - 1);
+        bits.Resize(66);
+        assert(bits.Count() == 2 + 63 && bits.Words().GetSize() == 2 && bits.Words()[1] == 3);
+        bits.PopBack();
+        assert(bits.GetSize() == 65 && bits.Words()[1] == 1);
+    }
+    {
+        SimpleBitVector<> evens(1000), threes(1000);
+        for (size_t i = 0; i < 1000; ++i) {
+            evens.Set(i, i % 2 == 0);
+            threes.Set(i, i % 3 == 0);
+        }
+        assert((evens & threes).Count() == 167);
+        assert((evens | threes).Count() == 500 + 334 - 167);
+        assert((evens ^ threes).Count() == 500 + 334 - 2 * 167);
+        SimpleBitVector<> all(1000, true);
+        assert(all.All() && all.Count() == 1000 && (all ^ all).None());
+        assert((evens | all) == all && evens != threes);
+        SimpleBitVector<> literal{true, false, true};
+        assert(literal.Count() == 2 && literal.Words()[0] == 0b101);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestVectorStream() {
+    cout << "Test vector streams" << endl;
+    {
+        // 7-byte writes and a 40-byte read chunk split records across reads
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        SimpleVector<Point> points;
+        for (int i = 0; i < 5'000; ++i) {
+            points.PushBack({i, -i * 0.25});
+        }
+        thread producer([&] {
+            VectorWriter<Point> writer(pipe_fds[1], 7);
+            writer.Write(points);
+            close(pipe_fds[1]);
+        });
+        SimpleVector<Point> received{{-1, 0.0}};
+        VectorReader<Point> reader(pipe_fds[0], 40);
+        assert(reader.ReadAll(received) == 5'000);
+        producer.join();
+        close(pipe_fds[0]);
+        assert(reader.AtEnd() && reader.GetPendingBytes() == 0 && received.GetSize() == 5'001);
+        assert(received[0].x == -1 && received[5'000].x == 4'999 && received[5'000].y == -4'999 * 0.25);
+    }
+    {
+        stringstream stream;
+        VectorWriter<int64_t> writer(stream);
+        writer.WriteBatch({SimpleVector<int64_t>{1, 2, 3}, vector<int64_t>{4, 5}});
+        SimpleVector<int64_t> values(Reserve(100));
+        VectorReader<int64_t> reader(stream);
+        assert(reader.ReadSome(values) == 5 && reader.AtEnd() && values.GetCapacity() == 100);
+        assert(values == SimpleVector<int64_t>({1, 2, 3, 4, 5}));
+
+        // short reads into an AutoShrink vector keep its spare capacity for the next read
+        stringstream short_stream;
+        VectorWriter<int64_t>(short_stream).Write(SimpleVector<int64_t>{6, 7});
+        SimpleVector<int64_t, allocator<int64_t>, AutoShrink<>> shrinking(Reserve(100));
+        VectorReader<int64_t> short_reader(short_stream);
+        assert(short_reader.ReadSome(shrinking) == 2 && shrinking.GetCapacity() == 100);
+
+        stringstream truncated(string(sizeof(int64_t) * 2 + 3, '\0'));
+        VectorReader<int64_t> truncated_reader(truncated, 1);
+        try {
+            truncated_reader.ReadAll(values);
+            assert(false);
+        } catch (const VectorFormatError&) {
+        }
+        assert(values.GetSize() == 7 && truncated_reader.GetPendingBytes() == 3);
+    }
+    {
+        char path[] = "/tmp/simple_vector_stream_XXXXXX";
+        const int fd = mkstemp(path);
+        assert(fd >= 0);
+        const SimpleVector<int> first(10'000, 1);
+        const SimpleVector<int> second(3, 2);
+        VectorWriter<int>(fd).WriteBatch({first, second, SimpleVectorView<const int>()});
+        lseek(fd, 0, SEEK_SET);
+        SimpleVector<int> values;
+        VectorReader<int>(fd, 4'096).ReadAll(values);
+        assert(values.GetSize() == 10'003 && values[9'999] == 1 && values[10'000] == 2);
+        close(fd);
+        unlink(path);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestUnorderedErase() {
+    cout << "Test unordered erase" << endl;
+    {
+        SimpleVector<string> v{"a", "b", "c", "d"};
+        auto pos = v.UnorderedErase(v.begin());
+        assert(*pos == "d" && v == SimpleVector<string>({"d", "b", "c"}));
+        v.SwapRemove(2);
+        assert(v == SimpleVector<string>({"d", "b"}));
+        pos = v.UnorderedErase(v.begin() + 1);
+        assert(pos == v.end() && v.GetSize() == 1);
+    }
+    {
+        ResetVectorStats();
+        SimpleVector<int> v = GenerateVector(1000);
+        assert(v.UnorderedEraseIf([](int x) { return x % 10 == 0; }) == 100);
+        assert(v.GetSize() == 900 && none_of(v.begin(), v.end(), [](int x) { return x % 10 == 0; }));
+        SimpleVector<int> sorted = v;
+        sort(sorted.begin(), sorted.end());
+        assert(sorted[0] == 1 && sorted[8] == 9 && sorted[9] == 11 && sorted[899] == 999);
+        assert(VectorStatsOf<int>().Snapshot().elements_shifted == 0);
+
+        assert(v.UnorderedEraseIf([](int) { return true; }) == 900 && v.IsEmpty());
+        SimpleVector<X> moved_only;
+        moved_only.EmplaceBack(1);
+        moved_only.EmplaceBack(2);
+        moved_only.EmplaceBack(3);
+        assert(moved_only.UnorderedEraseIf([](const X& x) { return x.GetX() == 1; }) == 1);
+        assert(moved_only[0].GetX() == 3 && moved_only[1].GetX() == 2);
+    }
+    {
+        TombstoneSimpleVector<string> entities;
+        for (int i = 0; i < 10; ++i) {
+            assert(entities.EmplaceBack(to_string(i)) == static_cast<size_t>(i));
+        }
+        entities.Erase(0);
+        entities.Erase(5);
+        entities.Erase(9);
+        assert(entities.GetSize() == 10 && entities.GetLiveCount() == 7 && entities.IsErased(5));
+        assert(entities[6] == "6" && entities.At(4) == "4");
+        try {
+            entities.At(5);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        string joined;
+        entities.ForEachLive([&](size_t, const string& s) { joined += s; });
+        assert(joined == "1234678");
+        assert(!entities.CompactIfSparse());
+
+        assert(entities.Compact() == 3 && entities.GetSize() == 7 && entities.GetDeadCount() == 0);
+        assert(entities.GetItems() == SimpleVector<string>({"1", "2", "3", "4", "6", "7", "8"}));
+        assert(!entities.IsErased(6) && entities.Compact() == 0);
+        for (size_t i = 0; i < 5; ++i) {
+            entities.Erase(i);
+        }
+        assert(entities.CompactIfSparse() && entities.GetItems() == SimpleVector<string>({"7", "8"}));
+    }
+    {
+        // the dead bits are allocated from the container's allocator too
+        Arena arena;
+        {
+            TombstoneSimpleVector<int, ArenaAllocator<int>> ids{ArenaAllocator<int>(arena)};
+            ids.Reserve(1000);
+            assert(arena.allocations == 2);
+            for (int i = 0; i < 1000; ++i) {
+                ids.PushBack(i);
+            }
+            ids.Erase(10);
+            assert(ids.Compact() == 1 && ids.GetSize() == 999 && arena.allocations == 2);
+        }
+        assert(arena.bytes_in_use == 0);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestFlatContainers() {
+    cout << "Test flat set and map" << endl;
+    {
+        FlatSet<int> set{5, 1, 4, 1, 3, 5, 2};
+        assert(set.GetSize() == 5 && equal(set.begin(), set.end(), SimpleVector<int>({1, 2, 3, 4, 5}).begin()));
+        assert(set.Contains(3) && !set.Contains(0) && !set.Contains(6) && set.Count(4) == 1);
+        assert(*set.LowerBound(0) == 1 && set.LowerBound(6) == set.end() && *set.UpperBound(3) == 4);
+        assert(set.Insert(0).second && !set.Insert(3).second && *set.begin() == 0);
+        assert(set.Erase(0) == 1 && set.Erase(0) == 0 && set.GetSize() == 5);
+        assert((set <=> FlatSet<int>{1, 2, 4}) == strong_ordering::less && set == FlatSet<int>({5, 4, 3, 2, 1}));
+
+        FlatSet<int> empty;
+        assert(!empty.Contains(1) && empty.Find(1) == empty.end() && empty.LowerBound(1) == empty.begin());
+        FlatSet<int> sorted(sorted_unique, SimpleVector<int>{1, 3, 5});
+        assert(sorted.Contains(5) && !sorted.Contains(4));
+    }
+    {
+        // every position of a lower bound in sets of every size up to 33
+        for (int size = 0; size <= 33; ++size) {
+            SimpleVector<int> keys(size);
+            for (int i = 0; i < size; ++i) {
+                keys[i] = 2 * i;
+            }
+            FlatSet<int> set(keys.begin(), keys.end());
+            for (int key = -1; key <= 2 * size; ++key) {
+                assert(set.LowerBound(key) == lower_bound(set.begin(), set.end(), key));
+                assert(set.Contains(key) == (key >= 0 && key < 2 * size && key % 2 == 0));
+            }
+        }
+    }
+    {
+        FlatSet<int> set = {10, 20, 30};
+        SimpleVector<int> batch = GenerateVector(40);
+        ResetVectorStats();
+        assert(set.InsertBatch(batch) == 37);
+        assert(VectorStatsOf<int>().Snapshot().elements_shifted == 0);
+        assert(set.GetSize() == 40 && is_sorted(set.begin(), set.end()));
+        assert(set.InsertBatch(SimpleVector<int>{5, 5, 50, 50}) == 1 && set.GetSize() == 41);
+    }
+    {
+        FlatMap<string, int> map{{"b", 2}, {"a", 1}, {"c", 3}, {"a", 100}};
+        assert(map.GetSize() == 3 && map.At("a") == 1 && map.begin()->first == "a");
+        assert(map.Find("c")->second == 3 && map.Find("d") == map.end());
+        // transparent lookup, no string is built for the key
+        assert(map.Contains(string_view("b")));
+        try {
+            map.At("d");
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+        map["d"] += 4;
+        assert(map.At("d") == 4 && map.GetSize() == 4);
+        assert(!map.Insert({"a", 7}).second && map.At("a") == 1);
+        assert(!map.InsertOrAssign("a", 7).second && map.At("a") == 7);
+        assert(map.TryEmplace("e", 5).second && prev(map.end())->first == "e");
+
+        SimpleVector<pair<string, int>> batch{{"f", 6}, {"0", 0}, {"a", -1}, {"f", -6}};
+        assert(map.InsertBatch(batch) == 2 && map.GetSize() == 7);
+        assert(map.At("a") == 7 && map.At("f") == 6 && map.begin()->first == "0");
+        assert(map.Erase("0") == 1 && map.begin()->first == "a");
+        for (auto& [key, value] : map) {
+            value = static_cast<int>(key[0]);
+        }
+        assert(as_const(map).At("b") == 'b');
+        assert(map.EraseIf([](const auto& entry) { return entry.second > 'c'; }) == 3 && map.GetSize() == 3);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestVectorHash() {
+    cout << "Test vector hash" << endl;
+    {
+        hash<SimpleVector<int>> hasher;
+        SimpleVector<int> v = GenerateVector(100);
+        SimpleVector<int> copy = v;
+        assert(hasher(v) == hasher(copy) && hasher(v) == hash<SimpleVectorView<const int>>()(copy));
+        copy[99] = 0;
+        assert(hasher(v) != hasher(copy));
+        assert(hasher(SimpleVector<int>()) != hasher(SimpleVector<int>(1)));
+
+        // every length up to 100 takes a different path through the byte hash
+        SimpleVector<uint8_t> bytes(100, uint8_t{7});
+        unordered_set<uint64_t> hashes;
+        for (size_t size = 0; size <= bytes.GetSize(); ++size) {
+            hashes.insert(vector_hash::Hash(bytes.cbegin(), size));
+            if (size > 0) {
+                bytes[size - 1] = 8;
+                hashes.insert(vector_hash::Hash(bytes.cbegin(), size));
+                bytes[size - 1] = 7;
+            }
+        }
+        assert(hashes.size() == 201);
+        assert(vector_hash::Hash(bytes.cbegin(), 10, 1) != vector_hash::Hash(bytes.cbegin(), 10, 2));
+    }
+    {
+        // elements without a byte representation are hashed one by one
+        SimpleVector<string> words{"ab", "c"};
+        hash<SimpleVector<string>> hasher;
+        assert(hasher(words) == hasher(SimpleVector<string>{"ab", "c"}));
+        assert(hasher(words) != hasher(SimpleVector<string>{"a", "bc"}));
+        static_assert(!is_default_constructible_v<hash<SimpleVector<Point>>>);
+
+        unordered_set<SimpleVector<int>> keys;
+        for (int i = 0; i < 100; ++i) {
+            keys.insert(SimpleVector<int>(i % 10, i % 10));
+        }
+        assert(keys.size() == 10 && keys.contains(SimpleVector<int>(3, 3)));
+    }
+    {
+        CowSimpleVector<int> cow(GenerateVector(1000));
+        const uint64_t expected = vector_hash::Hash(cow.cbegin(), cow.GetSize());
+        assert(cow.Hash() == expected && hash<CowSimpleVector<int>>()(cow) == expected);
+        CowSimpleVector<int> copy = cow;
+        assert(copy.Hash() == expected);
+        copy[0] = -1;
+        assert(copy.Hash() != expected && cow.Hash() == expected);
+        cow.Mutable()[0] = -1;
+        assert(cow.Hash() == copy.Hash());
+        assert(CowSimpleVector<int>().Hash() == hash<SimpleVector<int>>()(SimpleVector<int>()));
+    }
+    cout << "Done!" << endl << endl;
+}
+
+// Counts the calls that reach the upstream resource
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+void TestPmrVector() {
+    cout << "Test pmr vector" << endl;
+    {
+        // scratch that never falls back to the heap: the arena's upstream refuses to allocate
+        alignas(std::max_align_t) char buffer[4096];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        ::pmr::SimpleVector<int> v(&arena);
+        v.Reserve(100);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.GetAllocator().resource() == &arena);
+        const auto* data = reinterpret_cast<const char*>(v.cbegin());
+        assert(data >= buffer && data < buffer + sizeof(buffer));
+
+        ::pmr::SimpleVector<int> moved(std::move(v));
+        assert(moved.GetAllocator().resource() == &arena && moved.cbegin() == reinterpret_cast<const int*>(data));
+        // copies are not tied to the source's resource
+        ::pmr::SimpleVector<int> copy(moved);
+        assert(copy.GetAllocator().resource() == std::pmr::get_default_resource() && copy == moved);
+    }
+    {
+        CountingResource first;
+        CountingResource second;
+        ::pmr::SimpleVector<int> lhs(10, 1, &first);
+        ::pmr::SimpleVector<int> rhs(20, 2, &second);
+        const int* rhs_data = rhs.cbegin();
+        // different resources: the elements move, the buffer and the resource stay
+        lhs = std::move(rhs);
+        assert(lhs.GetAllocator().resource() == &first && lhs.cbegin() != rhs_data);
+        assert(lhs == ::pmr::SimpleVector<int>(20, 2) && first.allocations == 2 && second.allocations == 1);
+
+        ::pmr::SimpleVector<int> same(5, 3, &first);
+        const int* same_data = same.cbegin();
+        lhs = std::move(same);
+        assert(lhs.cbegin() == same_data && first.allocations == 3 && first.deallocations == 2);
+
+        const ::pmr::SimpleVector<int> source(3, 4, &second);
+        lhs = source;
+        assert(lhs.GetAllocator().resource() == &first && lhs == ::pmr::SimpleVector<int>(3, 4));
+    }
+    {
+        // elements that use an allocator are built on the vector's resource
+        std::pmr::unsynchronized_pool_resource pool;
+        ::pmr::SimpleVector<std::pmr::string> strings(&pool);
+        strings.EmplaceBack("a string long enough to need its own allocation");
+        strings.PushBack(std::pmr::string("another string too long for the small buffer"));
+        assert(strings[0].get_allocator().resource() == &pool && strings[1].get_allocator().resource() == &pool);
+
+        ::pmr::SimpleVector<::pmr::SimpleVector<int>> nested(&pool);
+        nested.EmplaceBack();
+        nested[0].PushBack(1);
+        assert(nested[0].GetAllocator().resource() == &pool);
+
+        ::pmr::SmallSimpleVector<int, 4> small(&pool);
+        for (int i = 0; i < 10; ++i) {
+            small.PushBack(i);
+        }
+        assert(small.GetAllocator().resource() == &pool && small[9] == 9);
+        ::pmr::SimpleBitVector<> bits(&pool);
+        bits.Resize(1000, true);
+        assert(bits.GetAllocator().resource() == &pool && bits.Count() == 1000);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestStreamingCopy() {
+    cout << "Test streaming copy" << endl;
+    {
+        SimpleVector<uint8_t> source(1024);
+        iota(source.begin(), source.end(), uint8_t{0});
+        SimpleVector<uint8_t> dest(1024);
+        // every alignment of both ends around the line-sized loop
+        for (size_t source_offset = 0; source_offset < 64; source_offset += 7) {
+            for (size_t dest_offset = 0; dest_offset < 64; ++dest_offset) {
+                for (size_t bytes : {0, 1, 63, 64, 65, 200, 900}) {
+                    fill(dest.begin(), dest.end(), uint8_t{0});
+                    memory_copy::StreamingCopy(dest.begin() + dest_offset, source.cbegin() + source_offset, bytes);
+                    assert(equal(dest.begin() + dest_offset, dest.begin() + dest_offset + bytes,
+                                 source.begin() + source_offset));
+                    auto is_zero = [](uint8_t byte) { return byte == 0; };
+                    assert(all_of(dest.begin(), dest.begin() + dest_offset, is_zero));
+                    assert(all_of(dest.begin() + dest_offset + bytes, dest.end(), is_zero));
+                }
+            }
+        }
+    }
+    {
+        // above the threshold, copies and relocations stream
+        const size_t size = memory_copy::kStreamingThreshold / sizeof(int) + 123;
+        SimpleVector<int> large = GenerateVector(size);
+        SimpleVector<int> copy(large);
+        assert(copy == large);
+        copy.Reserve(copy.GetCapacity() * 2);
+        assert(copy == large);
+
+        ThreadPool pool(4);
+        SimpleVector<int> parallel(pool, large);
+        assert(parallel == large && parallel.GetAllocator() == large.GetAllocator());
+        const SimpleVector<int> small = GenerateVector(100);
+        assert(SimpleVector<int>(pool, small) == small);
+
+        SimpleVector<string> strings(100000);
+        for (size_t i = 0; i < strings.GetSize(); ++i) {
+            strings[i] = to_string(i);
+        }
+        SimpleVector<string> parallel_strings(pool, strings);
+        assert(parallel_strings == strings);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestOperationBudgets() {
+    cout << "Test operation budgets" << endl;
+    const size_t n = 1000;
+    Counted::Reset();
+    {
+        const Counted value(1);
+        SimpleVector<Counted> v;
+        Counted::Reset();
+        ResetVectorStats();
+        for (size_t i = 0; i < n; ++i) {
+            v.PushBack(value);
+        }
+        const Counted::Counts counts = Counted::Reset();
+        CheckBudget("PushBack(const&) x1000", "copies", counts.Copies(), n);
+        // doubling relocates 1 + 2 + ... + 512 elements on the way to 1000
+        CheckBudget("PushBack(const&) x1000", "moves", counts.Moves(), 2 * n);
+        CheckBudget("PushBack(const&) x1000", "allocations", AllocationsSinceReset(), 11);
+    }
+    {
+        SimpleVector<Counted> v;
+        Counted::Reset();
+        ResetVectorStats();
+        v.Reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        const Counted::Counts counts = Counted::Reset();
+        CheckBudget("Reserve + EmplaceBack x1000", "copies and moves", counts.Copies() + counts.Moves(), 0);
+        CheckBudget("Reserve + EmplaceBack x1000", "allocations", AllocationsSinceReset(), 1);
+
+        v.Clear();
+        Counted::Reset();
+        for (size_t i = 0; i < n; ++i) {
+            v.PushBack(Counted(static_cast<int>(i)));
+        }
+        CheckBudget("PushBack(&&) x1000 into reserved", "moves", Counted::Reset().Moves(), n);
+    }
+    {
+        SimpleVector<Counted> source(n);
+        Counted::Reset();
+        ResetVectorStats();
+        SimpleVector<Counted> copy(source);
+        CheckBudget("Copy construction of 1000", "copies", Counted::Reset().Copies(), n);
+        CheckBudget("Copy construction of 1000", "allocations", AllocationsSinceReset(), 1);
+
+        SimpleVector<Counted> target(10);
+        Counted::Reset();
+        ResetVectorStats();
+        target = copy;
+        CheckBudget("Copy assignment of 1000", "copies", Counted::Reset().Copies(), n);
+        CheckBudget("Copy assignment of 1000", "allocations", AllocationsSinceReset(), 1);
+
+        ResetVectorStats();
+        SimpleVector<Counted> moved(move(copy));
+        target = move(moved);
+        target.swap(source);
+        const Counted::Counts counts = Counted::Reset();
+        CheckBudget("Move construction, move assignment, swap", "element operations",
+                    counts.constructions + counts.Copies() + counts.Moves(), 0);
+        CheckBudget("Move construction, move assignment, swap", "allocations", AllocationsSinceReset(), 0);
+    }
+    {
+        SimpleVector<Counted> v(n);
+        v.Reserve(2 * n);
+        const SimpleVector<Counted> batch(100);
+        ResetVectorStats();
+        Counted::Reset();
+        v.Insert(v.begin() + n / 2, Counted(1));
+        // the value is moved out of the argument before the tail shifts, in case it aliases
+        CheckBudget("Insert in the middle of 1000", "moves", Counted::Reset().Moves(), n / 2 + 2);
+
+        v.InsertRange(v.begin(), batch.begin(), batch.end());
+        Counted::Counts counts = Counted::Reset();
+        CheckBudget("InsertRange of 100 at the front", "moves", counts.Moves(), v.GetSize() - batch.GetSize());
+        CheckBudget("InsertRange of 100 at the front", "copies", counts.Copies(), batch.GetSize());
+        CheckBudget("Insert and InsertRange with capacity", "allocations", AllocationsSinceReset(), 0);
+
+        const size_t size = v.GetSize();
+        v.Erase(v.begin());
+        counts = Counted::Reset();
+        CheckBudget("Erase at the front", "moves", counts.Moves(), size - 1);
+        CheckBudget("Erase at the front", "destructions", counts.destructions, 1);
+
+        v.UnorderedErase(v.begin());
+        CheckBudget("UnorderedErase at the front", "moves", Counted::Reset().Moves(), 1);
+
+        const size_t before = v.GetSize();
+        size_t index = 0;
+        v.EraseIf([&index](const Counted&) { return index++ % 2 == 0; });
+        counts = Counted::Reset();
+        CheckBudget("EraseIf of every other element", "moves", counts.Moves(), before);
+        CheckBudget("EraseIf of every other element", "destructions", counts.destructions, (before + 1) / 2);
+    }
+    {
+        SimpleVector<Counted> v(n);
+        Counted::Reset();
+        ResetVectorStats();
+        v.Resize(2 * n);
+        Counted::Counts counts = Counted::Reset();
+        CheckBudget("Resize from 1000 to 2000", "constructions", counts.constructions, n);
+        CheckBudget("Resize from 1000 to 2000", "moves", counts.Moves(), n);
+        CheckBudget("Resize from 1000 to 2000", "allocations", AllocationsSinceReset(), 1);
+
+        v.Resize(n / 2);
+        v.ShrinkToFit();
+        counts = Counted::Reset();
+        CheckBudget("Resize to 500 and ShrinkToFit", "moves", counts.Moves(), n / 2);
+        CheckBudget("Resize to 500 and ShrinkToFit", "destructions", counts.destructions, 2 * n);
+
+        ResetVectorStats();
+        v.Clear();
+        v.PopBack();
+        CheckBudget("Clear", "destructions", Counted::Reset().destructions, n / 2);
+        CheckBudget("Clear", "allocations", AllocationsSinceReset(), 0);
+    }
+    // every object built by the tests above has been destroyed
+    assert(Counted::Reset().Alive() == 0);
     cout << "Done!" << endl << endl;
 }
 
@@ -155,5 +2239,34 @@ int main() {
     TestNoncopiablePushBack();
     TestNoncopiableInsert();
     TestNoncopiableErase();
+    TestReserveWithoutConstruction();
+    TestEmplace();
+    TestRelocationStrategy();
+    TestStatefulAllocator();
+    TestSmallVector();
+    TestGrowthPolicy();
+    TestShrinkToFit();
+    TestRangeOperations();
+    TestInstrumentation();
+    TestComparisonKernels();
+    TestParallelAlgorithms();
+    TestConcurrentVector();
+    TestBufferPool();
+    TestMappedVector();
+    TestVectorView();
+    TestCowVector();
+    TestSoAVector();
+    TestSegmentedVector();
+    TestLargePageAllocator();
+    TestStaticVector();
+    TestUncheckedAppend();
+    TestBitVector();
+    TestVectorStream();
+    TestUnorderedErase();
+    TestFlatContainers();
+    TestVectorHash();
+    TestPmrVector();
+    TestStreamingCopy();
+    TestOperationBudgets();
     return 0;
 }
@@ -0,0 +1,365 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "simple_vector.h"
+
+// Binary snapshot of a vector of trivially copyable elements: a 64-byte header followed,
+// at data_offset, by the raw element bytes in host byte order. Files are written by Save,
+// read back into a SimpleVector by LoadSimpleVector or mapped in place by MappedSimpleVector.
+struct VectorFileHeader {
+    static constexpr char kMagic[8] = {'S', 'V', 'E', 'C', 'T', 'O', 'R', '\0'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kByteOrderMark = 0x01020304;
+    static constexpr size_t kDataAlignment = 64;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t element_size;
+    uint64_t alignment;
+    uint64_t count;
+    uint64_t data_offset;
+    uint64_t checksum;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(VectorFileHeader) == 64 && std::is_trivially_copyable_v<VectorFileHeader>);
+
+class VectorFormatError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// FNV-1a over 8-byte words, then over the remaining bytes
+inline uint64_t VectorChecksum(const void* data, size_t bytes) noexcept {
+    constexpr uint64_t kPrime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull;
+    const auto* bytes_ptr = static_cast<const unsigned char*>(data);
+    for (; bytes >= 8; bytes_ptr += 8, bytes -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes_ptr, 8);
+        hash = (hash ^ word) * kPrime;
+    }
+    for (; bytes > 0; ++bytes_ptr, --bytes) {
+        hash = (hash ^ *bytes_ptr) * kPrime;
+    }
+    return hash;
+}
+
+namespace vector_file {
+
+template <typename Type>
+VectorFileHeader MakeHeader(const Type* data, size_t count) noexcept {
+    static_assert(std::is_trivially_copyable_v<Type>, "only trivially copyable elements can be saved as bytes");
+    VectorFileHeader header{};
+    std::memcpy(header.magic, VectorFileHeader::kMagic, sizeof(header.magic));
+    header.version = VectorFileHeader::kVersion;
+    header.byte_order = VectorFileHeader::kByteOrderMark;
+    header.element_size = sizeof(Type);
+    header.alignment = alignof(Type);
+    header.count = count;
+    header.data_offset = std::max(sizeof(VectorFileHeader), std::max(alignof(Type), VectorFileHeader::kDataAlignment));
+    header.checksum = VectorChecksum(data, count * sizeof(Type));
+    return header;
+}
+
+// Throws VectorFormatError unless header describes Type elements that fit into file_size bytes.
+// file_size is unknown for streams.
+template <typename Type>
+void Validate(const VectorFileHeader& header, uint64_t file_size = UINT64_MAX) {
+    if (std::memcmp(header.magic, VectorFileHeader::kMagic, sizeof(header.magic)) != 0) {
+        throw VectorFormatError("Not a SimpleVector file");
+    }
+    if (header.version != VectorFileHeader::kVersion) {
+        throw VectorFormatError("Unsupported SimpleVector file version " + std::to_string(header.version));
+    }
+    if (header.byte_order != VectorFileHeader::kByteOrderMark) {
+        throw VectorFormatError("SimpleVector file has foreign byte order");
+    }
+    if (header.element_size != sizeof(Type) || header.alignment != alignof(Type)) {
+        throw VectorFormatError("SimpleVector file element layout does not match the requested type");
+    }
+    if (header.data_offset < sizeof(VectorFileHeader) || header.data_offset % alignof(Type) != 0
+        || header.count > (UINT64_MAX - header.data_offset) / sizeof(Type)
+        || header.data_offset + header.count * sizeof(Type) > file_size) {
+        throw VectorFormatError("SimpleVector file is truncated or corrupt");
+    }
+}
+
+inline void WriteAll(int fd, const void* data, size_t bytes) {
+    const auto* bytes_ptr = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const ssize_t written = ::write(fd, bytes_ptr, bytes);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+        bytes_ptr += written;
+        bytes -= written;
+    }
+}
+
+inline void ReadAll(int fd, void* data, size_t bytes) {
+    auto* bytes_ptr = static_cast<char*>(data);
+    while (bytes > 0) {
+        const ssize_t done = ::read(fd, bytes_ptr, bytes);
+        if (done < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (done == 0) {
+            throw VectorFormatError("SimpleVector file is truncated or corrupt");
+        }
+        bytes_ptr += done;
+        bytes -= done;
+    }
+}
+
+inline void ReadAll(std::istream& input, void* data, size_t bytes) {
+    if (!input.read(static_cast<char*>(data), bytes)) {
+        throw VectorFormatError("SimpleVector file is truncated or corrupt");
+    }
+}
+
+// Bytes from the current offset to the end of fd, unknown (UINT64_MAX) unless it is a regular file
+inline uint64_t RemainingBytes(int fd) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        throw std::system_error(errno, std::generic_category(), "fstat");
+    }
+    const off_t offset = S_ISREG(info.st_mode) ? ::lseek(fd, 0, SEEK_CUR) : -1;
+    if (offset < 0) {
+        return UINT64_MAX;
+    }
+    return info.st_size > offset ? static_cast<uint64_t>(info.st_size - offset) : 0;
+}
+
+inline uint64_t RemainingBytes(std::istream&) noexcept {
+    return UINT64_MAX;
+}
+
+template <typename Type, typename Source>
+SimpleVector<Type> Load(Source& source) {
+    // a count past the end of the file is rejected before allocating for it
+    const uint64_t file_size = RemainingBytes(source);
+    VectorFileHeader header;
+    ReadAll(source, &header, sizeof(header));
+    Validate<Type>(header, file_size);
+    char padding[VectorFileHeader::kDataAlignment];
+    for (size_t skip = header.data_offset - sizeof(header); skip > 0;) {
+        const size_t chunk = std::min(skip, sizeof(padding));
+        ReadAll(source, padding, chunk);
+        skip -= chunk;
+    }
+    // trivially copyable elements come to life as their bytes are read into raw storage
+    ArrayPtr<Type> storage(header.count, uninitialized);
+    ReadAll(source, storage.GetRawPtr(), header.count * sizeof(Type));
+    if (VectorChecksum(storage.GetRawPtr(), header.count * sizeof(Type)) != header.checksum) {
+        throw VectorFormatError("SimpleVector file checksum mismatch");
+    }
+    return SimpleVector<Type>(std::move(storage), header.count);
+}
+
+}  // namespace vector_file
+
+template <std::ranges::contiguous_range Range>
+void Save(int fd, const Range& range) {
+    const auto* data = std::ranges::data(range);
+    const size_t count = std::ranges::size(range);
+    const VectorFileHeader header = vector_file::MakeHeader(data, count);
+    vector_file::WriteAll(fd, &header, sizeof(header));
+    const char padding[VectorFileHeader::kDataAlignment] = {};
+    for (size_t skip = header.data_offset - sizeof(header); skip > 0;) {
+        const size_t chunk = std::min(skip, sizeof(padding));
+        vector_file::WriteAll(fd, padding, chunk);
+        skip -= chunk;
+    }
+    vector_file::WriteAll(fd, data, count * sizeof(*data));
+}
+
+template <std::ranges::contiguous_range Range>
+void Save(std::ostream& output, const Range& range) {
+    const auto* data = std::ranges::data(range);
+    const size_t count = std::ranges::size(range);
+    const VectorFileHeader header = vector_file::MakeHeader(data, count);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t skip = header.data_offset - sizeof(header); skip > 0; --skip) {
+        output.put('\0');
+    }
+    output.write(reinterpret_cast<const char*>(data), count * sizeof(*data));
+    if (!output) {
+        throw std::runtime_error("Failed to write SimpleVector file");
+    }
+}
+
+// Reads a file written by Save in one allocation, verifying the checksum
+template <typename Type>
+SimpleVector<Type> LoadSimpleVector(int fd) {
+    return vector_file::Load<Type>(fd);
+}
+
+template <typename Type>
+SimpleVector<Type> LoadSimpleVector(std::istream& input) {
+    return vector_file::Load<Type>(input);
+}
+
+// Read-only view of a file written by Save, mapped into memory instead of read, so
+// pages are faulted in as they are touched. The header is validated on opening;
+// the checksum needs every page and is only checked by Verify.
+template <typename Type>
+class MappedSimpleVector {
+    static_assert(std::is_trivially_copyable_v<Type>);
+
+public:
+    using Iterator = const Type*;
+    using ConstIterator = const Type*;
+
+    MappedSimpleVector() noexcept = default;
+
+    explicit MappedSimpleVector(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        try {
+            Map(fd);
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+    }
+
+    // The mapping stays valid after fd is closed
+    explicit MappedSimpleVector(int fd) {
+        Map(fd);
+    }
+
+    MappedSimpleVector(MappedSimpleVector&& other) noexcept
+        : mapping_(std::exchange(other.mapping_, nullptr))
+        , mapping_size_(std::exchange(other.mapping_size_, 0))
+        , data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , checksum_(other.checksum_) {
+    }
+
+    MappedSimpleVector& operator=(MappedSimpleVector&& other) noexcept {
+        if (this != &other) {
+            MappedSimpleVector(std::move(other)).swap(*this);
+        }
+        return *this;
+    }
+
+    ~MappedSimpleVector() {
+        if (mapping_ != nullptr) {
+            ::munmap(mapping_, mapping_size_);
+        }
+    }
+
+    void swap(MappedSimpleVector& other) noexcept {
+        std::swap(mapping_, other.mapping_);
+        std::swap(mapping_size_, other.mapping_size_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(checksum_, other.checksum_);
+    }
+
+    bool Verify() const noexcept {
+        return VectorChecksum(data_, size_ * sizeof(Type)) == checksum_;
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data_[index];
+    }
+
+    ConstIterator begin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    void Map(int fd) {
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            throw std::system_error(errno, std::generic_category(), "fstat");
+        }
+        const auto file_size = static_cast<uint64_t>(info.st_size);
+        if (file_size < sizeof(VectorFileHeader)) {
+            throw VectorFormatError("Not a SimpleVector file");
+        }
+        void* mapping = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::system_error(errno, std::generic_category(), "mmap");
+        }
+        VectorFileHeader header;
+        std::memcpy(&header, mapping, sizeof(header));
+        try {
+            vector_file::Validate<Type>(header, file_size);
+        } catch (...) {
+            ::munmap(mapping, file_size);
+            throw;
+        }
+        mapping_ = mapping;
+        mapping_size_ = file_size;
+        data_ = reinterpret_cast<const Type*>(static_cast<const char*>(mapping) + header.data_offset);
+        size_ = header.count;
+        checksum_ = header.checksum;
+    }
+
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    const Type* data_ = nullptr;
+    size_t size_ = 0;
+    uint64_t checksum_ = VectorChecksum(nullptr, 0);
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "parallel_chunks.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <immintrin.h>
+#define SIMPLE_VECTOR_STREAMING_X86 1
+#endif
+
+// Bulk copies of bytes for copying and relocating large buffers. Below kStreamingThreshold
+// this is memcpy. From there on, well past the size of a last-level cache, the source is
+// prefetched with a non-temporal hint and the destination written with streaming stores,
+// so that copying a huge vector does not evict the working set of every other core.
+// The copy is then not in the cache either. Other targets always use memcpy.
+namespace memory_copy {
+
+inline constexpr size_t kStreamingThreshold = size_t{8} << 20;
+
+namespace detail {
+
+inline constexpr size_t kLineBytes = 64;
+inline constexpr size_t kPrefetchDistance = 8 * kLineBytes;
+
+}  // namespace detail
+
+// Copies bytes between non-overlapping buffers with streaming stores whatever the size
+inline void StreamingCopy(void* dest, const void* source, size_t bytes) noexcept {
+#if defined(SIMPLE_VECTOR_STREAMING_X86)
+    using detail::kLineBytes;
+    auto* to = static_cast<char*>(dest);
+    const auto* from = static_cast<const char*>(source);
+    // whole aligned lines let the write-combining buffers flush without reading memory
+    const size_t head = std::min((kLineBytes - reinterpret_cast<std::uintptr_t>(to) % kLineBytes) % kLineBytes, bytes);
+    std::memcpy(to, from, head);
+    to += head;
+    from += head;
+    bytes -= head;
+    for (; bytes >= kLineBytes; to += kLineBytes, from += kLineBytes, bytes -= kLineBytes) {
+        _mm_prefetch(from + detail::kPrefetchDistance, _MM_HINT_NTA);
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to), a);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + 48), d);
+    }
+    // streaming stores are weakly ordered: fence before anyone is told the copy is done
+    _mm_sfence();
+    std::memcpy(to, from, bytes);
+#else
+    if (bytes > 0) {
+        std::memcpy(dest, source, bytes);
+    }
+#endif
+}
+
+// Copies bytes between non-overlapping buffers, streaming from kStreamingThreshold on
+inline void Copy(void* dest, const void* source, size_t bytes) noexcept {
+    if (bytes >= kStreamingThreshold) {
+        StreamingCopy(dest, source, bytes);
+    } else if (bytes > 0) {
+        std::memcpy(dest, source, bytes);
+    }
+}
+
+// Copy split into cache-aligned chunks of the destination run on executor. Whether the
+// chunks stream is decided by the size of the whole copy.
+template <ParallelExecutor Executor>
+void ParallelCopy(Executor& executor, void* dest, const void* source, size_t bytes) {
+    const CacheAlignedChunks<char> chunks(static_cast<char*>(dest), bytes, executor.GetThreadCount());
+    if (chunks.GetCount() == 1) {
+        Copy(dest, source, bytes);
+        return;
+    }
+    const bool streaming = bytes >= kStreamingThreshold;
+    const auto* from = static_cast<const char*>(source);
+    executor.ParallelFor(chunks.GetCount(), [&](size_t index) {
+        char* first = chunks.First(index);
+        const size_t size = chunks.Last(index) - first;
+        const char* chunk_source = from + (first - static_cast<char*>(dest));
+        if (streaming) {
+            StreamingCopy(first, chunk_source, size);
+        } else if (size > 0) {
+            std::memcpy(first, chunk_source, size);
+        }
+    });
+}
+
+}  // namespace memory_copy
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+#include "parallel_chunks.h"
+#include "thread_pool.h"
+
+// Parallel versions of the common passes over a contiguous buffer such as SimpleVector.
+// The buffer is split into CacheAlignedChunks, each processed as one task on the pool;
+// small buffers run on the calling thread.
+
+template <std::ranges::contiguous_range Range, typename Function>
+void ParallelForEach(Range&& range, Function function, ThreadPool& pool = DefaultThreadPool()) {
+    const CacheAlignedChunks chunks(std::ranges::data(range), std::ranges::size(range), pool.GetThreadCount());
+    pool.ParallelFor(chunks.GetCount(), [&](size_t index) {
+        std::for_each(chunks.First(index), chunks.Last(index), function);
+    });
+}
+
+// Writes function(input[i]) to output[i]; output must hold at least as many elements as
+// input and may be input itself.
+template <std::ranges::contiguous_range Input, std::ranges::contiguous_range Output, typename Function>
+void ParallelTransform(const Input& input, Output&& output, Function function, ThreadPool& pool = DefaultThreadPool()) {
+    const auto* source = std::ranges::data(input);
+    auto* dest = std::ranges::data(output);
+    const CacheAlignedChunks chunks(dest, std::ranges::size(input), pool.GetThreadCount());
+    pool.ParallelFor(chunks.GetCount(), [&](size_t index) {
+        std::transform(source + (chunks.First(index) - dest), source + (chunks.Last(index) - dest),
+                       chunks.First(index), function);
+    });
+}
+
+// Folds the range into init with op, which must be associative; chunk results are
+// combined in order, so op need not be commutative.
+template <std::ranges::contiguous_range Range, typename T, typename BinaryOp = std::plus<>>
+T ParallelReduce(const Range& range, T init, BinaryOp op = BinaryOp(), ThreadPool& pool = DefaultThreadPool()) {
+    const CacheAlignedChunks chunks(std::ranges::data(range), std::ranges::size(range), pool.GetThreadCount());
+    std::vector<std::optional<T>> partial(chunks.GetCount());
+    pool.ParallelFor(chunks.GetCount(), [&](size_t index) {
+        auto first = chunks.First(index);
+        const auto last = chunks.Last(index);
+        if (first != last) {
+            T result = *first;
+            for (++first; first != last; ++first) {
+                result = op(std::move(result), *first);
+            }
+            partial[index] = std::move(result);
+        }
+    });
+    for (auto& result : partial) {
+        if (result) {
+            init = op(std::move(init), std::move(*result));
+        }
+    }
+    return init;
+}
+
+// Sorts every chunk in parallel, then merges neighbouring runs pairwise in parallel rounds.
+// Like std::sort, not stable.
+template <std::ranges::contiguous_range Range, typename Compare = std::ranges::less>
+void ParallelSort(Range&& range, Compare comp = Compare(), ThreadPool& pool = DefaultThreadPool()) {
+    const CacheAlignedChunks chunks(std::ranges::data(range), std::ranges::size(range), pool.GetThreadCount());
+    const size_t count = chunks.GetCount();
+    pool.ParallelFor(count, [&](size_t index) {
+        std::sort(chunks.First(index), chunks.Last(index), comp);
+    });
+    for (size_t width = 1; width < count; width *= 2) {
+        pool.ParallelFor((count + 2 * width - 1) / (2 * width), [&](size_t pair) {
+            const size_t first = pair * 2 * width;
+            if (first + width < count) {
+                std::inplace_merge(chunks.First(first), chunks.First(first + width),
+                                   chunks.Last(std::min(first + 2 * width, count) - 1), comp);
+            }
+        });
+    }
+}
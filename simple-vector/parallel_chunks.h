@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+// Anything that can run task(0) .. task(count - 1) concurrently and wait for all of them,
+// rethrowing the first exception. ThreadPool from thread_pool.h is the usual one.
+template <typename Executor>
+concept ParallelExecutor = requires(Executor& executor, void (*task)(size_t)) {
+    { executor.GetThreadCount() } -> std::convertible_to<size_t>;
+    executor.ParallelFor(size_t{}, task);
+};
+
+// Splits [data, data + count) into at most a few chunks per thread whose boundaries fall on
+// cache line boundaries, so that no two threads write to the same line. Buffers smaller
+// than kMinChunkBytes per chunk are not worth splitting and form a single chunk.
+template <typename Type>
+class CacheAlignedChunks {
+public:
+    static constexpr size_t kCacheLine = 64;
+    static constexpr size_t kMinChunkBytes = 64 * 1024;
+    static constexpr size_t kChunksPerThread = 4;
+
+    CacheAlignedChunks(Type* data, size_t count, size_t threads) noexcept
+        : data_(data)
+        , size_(count)
+        , count_(std::clamp<size_t>(count / std::max<size_t>(kMinChunkBytes / sizeof(Type), 1),
+                                    1, std::max<size_t>(threads, 1) * kChunksPerThread)) {
+    }
+
+    size_t GetCount() const noexcept {
+        return count_;
+    }
+
+    // Chunks may come out empty when the buffer is small compared to the line size
+    Type* First(size_t index) const noexcept {
+        return data_ + Boundary(index);
+    }
+
+    Type* Last(size_t index) const noexcept {
+        return data_ + Boundary(index + 1);
+    }
+
+private:
+    size_t Boundary(size_t index) const noexcept {
+        if (index == 0) {
+            return 0;
+        }
+        if (index >= count_) {
+            return size_;
+        }
+        size_t position = size_ / count_ * index + std::min(index, size_ % count_);
+        if constexpr (kCacheLine % sizeof(Type) == 0) {
+            const auto address = reinterpret_cast<std::uintptr_t>(data_ + position);
+            position += (kCacheLine - address % kCacheLine) % kCacheLine / sizeof(Type);
+        }
+        return std::min(position, size_);
+    }
+
+    Type* data_;
+    size_t size_;
+    size_t count_;
+};
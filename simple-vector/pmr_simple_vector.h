@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include "growth_policy.h"
+#include "simple_bit_vector.h"
+#include "simple_vector.h"
+#include "small_simple_vector.h"
+
+// Containers over std::pmr::polymorphic_allocator: the memory_resource is chosen at run
+// time, e.g. a monotonic_buffer_resource for per-frame scratch or a pool resource, and
+// the vector type stays the same.
+//
+// The allocator follows the pmr rules. Copies get the default resource, not the source's,
+// move construction keeps the source's resource, and assignment never changes it:
+// move-assigning from a vector on another resource moves the elements one by one instead
+// of adopting the buffer. Swapping vectors on different resources is undefined, as for
+// std::pmr::vector. Elements that take an allocator (pmr strings, nested pmr vectors) are
+// constructed on the vector's resource.
+//
+// A monotonic resource never reclaims the buffers left behind by growth; Reserve up front.
+//
+// With `using namespace std` in scope, write ::pmr:: to avoid ambiguity with std::pmr.
+namespace pmr {
+
+template <typename Type, typename GrowthPolicy = DoublingGrowth>
+using SimpleVector = ::SimpleVector<Type, std::pmr::polymorphic_allocator<Type>, GrowthPolicy>;
+
+template <typename Type, size_t N, typename GrowthPolicy = DoublingGrowth>
+using SmallSimpleVector = ::SmallSimpleVector<Type, N, std::pmr::polymorphic_allocator<Type>, GrowthPolicy>;
+
+template <typename GrowthPolicy = DoublingGrowth>
+using SimpleBitVector = ::SimpleBitVector<std::pmr::polymorphic_allocator<bit_kernels::Word>, GrowthPolicy>;
+
+}  // namespace pmr
@@ -0,0 +1,485 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+template <typename Vector, bool Const>
+class SegmentedIterator {
+    using Owner = std::conditional_t<Const, const Vector, Vector>;
+
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = typename Vector::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, const value_type&, value_type&>;
+    using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+    SegmentedIterator() noexcept = default;
+
+    SegmentedIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index) {
+    }
+
+    operator SegmentedIterator<Vector, true>() const noexcept
+        requires(!Const) {
+        return SegmentedIterator<Vector, true>(owner_, index_);
+    }
+
+    size_t GetIndex() const noexcept {
+        return index_;
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    pointer operator->() const noexcept {
+        return &(*owner_)[index_];
+    }
+
+    reference operator[](difference_type offset) const noexcept {
+        return (*owner_)[index_ + offset];
+    }
+
+    SegmentedIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    SegmentedIterator operator++(int) noexcept {
+        return SegmentedIterator(owner_, index_++);
+    }
+
+    SegmentedIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    SegmentedIterator operator--(int) noexcept {
+        return SegmentedIterator(owner_, index_--);
+    }
+
+    SegmentedIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+
+    SegmentedIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+
+    friend SegmentedIterator operator+(SegmentedIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+
+    friend SegmentedIterator operator+(difference_type offset, SegmentedIterator it) noexcept {
+        return it += offset;
+    }
+
+    friend SegmentedIterator operator-(SegmentedIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+
+    friend difference_type operator-(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const SegmentedIterator& lhs, const SegmentedIterator& rhs) noexcept {
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
+
+// SimpleVector interface over a table of fixed-size blocks. Growing allocates one more
+// block and never moves elements, so appends take bounded time however large the vector
+// is and references stay valid until the element is erased; only the table of block
+// pointers, BlockBytes-th of the data in size, is ever reallocated. operator[] is a
+// shift, a mask and one extra load. Insert and Erase shift the following elements
+// like SimpleVector does and invalidate what they shift.
+template <typename Type, typename Allocator = std::allocator<Type>, size_t BlockBytes = 64 * 1024>
+class SegmentedSimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using BlockPtr = ArrayPtr<Type, Allocator>;
+    using BlockTable = SimpleVector<Type*, typename AllocTraits::template rebind_alloc<Type*>>;
+
+public:
+    using value_type = Type;
+    using Iterator = SegmentedIterator<SegmentedSimpleVector, false>;
+    using ConstIterator = SegmentedIterator<SegmentedSimpleVector, true>;
+    using allocator_type = Allocator;
+
+    // Elements per block, the largest power of two that fits into BlockBytes
+    static constexpr size_t kBlockSize = std::bit_floor(std::max<size_t>(BlockBytes / sizeof(Type), 1));
+    static constexpr size_t kBlockShift = std::countr_zero(kBlockSize);
+
+    SegmentedSimpleVector() noexcept = default;
+
+    explicit SegmentedSimpleVector(const Allocator& alloc) noexcept
+        : alloc_(alloc)
+        , blocks_(typename BlockTable::allocator_type(alloc)) {
+    }
+
+    // The constructors below delegate first, so the destructor cleans up if filling throws
+
+    explicit SegmentedSimpleVector(size_t size, const Allocator& alloc = Allocator())
+        : SegmentedSimpleVector(alloc) {
+        Resize(size);
+    }
+
+    SegmentedSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : SegmentedSimpleVector(alloc) {
+        Reserve(size);
+        while (size_ < size) {
+            PushBack(value);
+        }
+    }
+
+    SegmentedSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+        : SegmentedSimpleVector(init.begin(), init.end(), alloc) {
+    }
+
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    SegmentedSimpleVector(InputIt first, Sentinel last, const Allocator& alloc = Allocator())
+        : SegmentedSimpleVector(alloc) {
+        Append(std::move(first), std::move(last));
+    }
+
+    SegmentedSimpleVector(const SegmentedSimpleVector& other)
+        : SegmentedSimpleVector(other.begin(), other.end(),
+                                AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    }
+
+    SegmentedSimpleVector(SegmentedSimpleVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , blocks_(std::move(other.blocks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    ~SegmentedSimpleVector() {
+        Clear();
+        ReleaseBlocks(0);
+    }
+
+    SegmentedSimpleVector& operator=(const SegmentedSimpleVector& other) {
+        if (this != &other) {
+            SegmentedSimpleVector copy(other.begin(), other.end(), alloc_);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    SegmentedSimpleVector& operator=(SegmentedSimpleVector&& other) noexcept(AllocTraits::is_always_equal::value) {
+        if (this != &other) {
+            if (alloc_ == other.alloc_) {
+                SegmentedSimpleVector moved(std::move(other));
+                swap(moved);
+            } else {
+                SegmentedSimpleVector buffer(std::make_move_iterator(other.begin()),
+                                             std::make_move_iterator(other.end()), alloc_);
+                swap(buffer);
+            }
+        }
+        return *this;
+    }
+
+    // Allocators must compare equal
+    void swap(SegmentedSimpleVector& other) noexcept {
+        blocks_.swap(other.blocks_);
+        std::swap(size_, other.size_);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // If a block has to be added, it is added before the element is constructed, so args may
+    // refer to elements of this vector
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (IsFull()) {
+            AddBlock();
+        }
+        Type* slot = Slot(size_);
+        Ops().ConstructAt(slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    void Append(InputIt first, Sentinel last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            Reserve(size_ + std::ranges::distance(first, last));
+        }
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    template <std::ranges::input_range Range>
+    void Append(Range&& range) {
+        Append(std::ranges::begin(range), std::ranges::end(range));
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Appends, then rotates the new element into place
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        const size_t offset = pos.GetIndex();
+        assert(offset <= size_);
+        EmplaceBack(std::forward<Args>(args)...);
+        if (offset + 1 != size_) {
+            VectorEvents<Type>::Shift(size_ - 1 - offset);
+            std::rotate(begin() + offset, end() - 1, end());
+        }
+        return begin() + offset;
+    }
+
+    void PopBack() noexcept {
+        if (!IsEmpty()) {
+            --size_;
+            Ops().DestroyAt(Slot(size_));
+        }
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        assert(pos.GetIndex() < size_);
+        return EraseRange(pos, pos + 1);
+    }
+
+    Iterator EraseRange(ConstIterator first, ConstIterator last) {
+        const size_t offset = first.GetIndex();
+        const size_t count = last - first;
+        assert(offset + count <= size_);
+        if (count > 0) {
+            if (offset + count != size_) {
+                VectorEvents<Type>::Shift(size_ - offset - count);
+            }
+            std::move(begin() + offset + count, end(), begin() + offset);
+            DestroyFrom(size_ - count);
+        }
+        return begin() + offset;
+    }
+
+    // Removes every element satisfying pred in a single compacting pass, returns the number removed
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        const size_t new_size = std::remove_if(begin(), end(), pred) - begin();
+        const size_t removed = size_ - new_size;
+        DestroyFrom(new_size);
+        return removed;
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return blocks_.GetSize() * kBlockSize;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    bool IsFull() const noexcept {
+        return size_ == GetCapacity();
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return blocks_[index >> kBlockShift][index & (kBlockSize - 1)];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return blocks_[index >> kBlockShift][index & (kBlockSize - 1)];
+    }
+
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Keeps the blocks for reuse, see ShrinkToFit
+    void Clear() noexcept {
+        DestroyFrom(0);
+    }
+
+    // New elements are value-initialized; they are destroyed again if one of them throws
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            DestroyFrom(new_size);
+            return;
+        }
+        Reserve(new_size);
+        const size_t old_size = size_;
+        try {
+            while (size_ < new_size) {
+                const size_t count = std::min(new_size - size_, kBlockSize - (size_ & (kBlockSize - 1)));
+                Ops().UninitializedConstruct(Slot(size_), count);
+                size_ += count;
+            }
+        } catch (...) {
+            DestroyFrom(old_size);
+            throw;
+        }
+    }
+
+    // Allocates blocks up front; none of the elements move
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > GetCapacity()) {
+            blocks_.Reserve((new_capacity + kBlockSize - 1) >> kBlockShift);
+            while (GetCapacity() < new_capacity) {
+                AddBlock();
+            }
+        }
+    }
+
+    // Releases the blocks past the last element
+    void ShrinkToFit() {
+        ReleaseBlocks((size_ + kBlockSize - 1) >> kBlockShift);
+        blocks_.ShrinkToFit();
+    }
+
+    size_t GetBlockCount() const noexcept {
+        return (size_ + kBlockSize - 1) >> kBlockShift;
+    }
+
+    // Elements of one block as a contiguous span, for loops that want to vectorize
+    SimpleVectorView<Type> Block(size_t block) noexcept {
+        assert(block < GetBlockCount());
+        return SimpleVectorView<Type>(blocks_[block], std::min(kBlockSize, size_ - (block << kBlockShift)));
+    }
+
+    SimpleVectorView<const Type> Block(size_t block) const noexcept {
+        assert(block < GetBlockCount());
+        return SimpleVectorView<const Type>(blocks_[block], std::min(kBlockSize, size_ - (block << kBlockShift)));
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, size_);
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Storage of element index, which may be past the size while elements are constructed
+    Type* Slot(size_t index) noexcept {
+        assert(index < GetCapacity());
+        return &blocks_[index >> kBlockShift][index & (kBlockSize - 1)];
+    }
+
+    void AddBlock() {
+        BlockPtr block(kBlockSize, uninitialized, alloc_);
+        blocks_.PushBack(block.GetRawPtr());
+        block.Release();
+    }
+
+    // Frees the blocks from index first on, which must hold no elements
+    void ReleaseBlocks(size_t first) noexcept {
+        while (blocks_.GetSize() > first) {
+            BlockPtr(blocks_[blocks_.GetSize() - 1], kBlockSize, uninitialized, alloc_);
+            blocks_.PopBack();
+        }
+    }
+
+    void DestroyFrom(size_t new_size) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<Type>) {
+            while (size_ > new_size) {
+                Ops().DestroyAt(Slot(--size_));
+            }
+        }
+        size_ = std::min(size_, new_size);
+    }
+
+    ElementOps<Type, Allocator> Ops() noexcept {
+        return ElementOps<Type, Allocator>(alloc_);
+    }
+
+    [[no_unique_address]] Allocator alloc_;
+    BlockTable blocks_;
+    size_t size_ = 0;
+};
+
+template <typename Type, typename Allocator, size_t BlockBytes>
+inline auto operator<=>(const SegmentedSimpleVector<Type, Allocator, BlockBytes>& lhs,
+                        const SegmentedSimpleVector<Type, Allocator, BlockBytes>& rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, typename Allocator, size_t BlockBytes>
+inline bool operator==(const SegmentedSimpleVector<Type, Allocator, BlockBytes>& lhs,
+                       const SegmentedSimpleVector<Type, Allocator, BlockBytes>& rhs) {
+    if (lhs.GetSize() != rhs.GetSize()) {
+        return false;
+    }
+    for (size_t block = 0; block < lhs.GetBlockCount(); ++block) {
+        if (lhs.Block(block) != rhs.Block(block)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+namespace bit_kernels {
+
+using Word = uint64_t;
+
+inline constexpr size_t kWordBits = 64;
+
+namespace detail {
+
+inline size_t CountPortable(const Word* words, size_t count) noexcept {
+    size_t bits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bits += std::popcount(words[i]);
+    }
+    return bits;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Without -mpopcnt std::popcount is a bit-twiddling sequence; compile a popcnt copy and pick it at run time
+[[gnu::target("popcnt")]] inline size_t CountPopcnt(const Word* words, size_t count) noexcept {
+    size_t bits = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bits += std::popcount(words[i]);
+    }
+    return bits;
+}
+
+inline bool HasPopcnt() noexcept {
+    static const bool has_popcnt = __builtin_cpu_supports("popcnt");
+    return has_popcnt;
+}
+
+#endif
+
+}  // namespace detail
+
+inline size_t Count(const Word* words, size_t count) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    if (detail::HasPopcnt()) {
+        return detail::CountPopcnt(words, count);
+    }
+#endif
+    return detail::CountPortable(words, count);
+}
+
+// Index of the first set bit at or after bit first in words[0, count), or count * kWordBits
+inline size_t FindSet(const Word* words, size_t count, size_t first) noexcept {
+    size_t word = first / kWordBits;
+    if (word >= count) {
+        return count * kWordBits;
+    }
+    Word bits = words[word] & (~Word{0} << (first % kWordBits));
+    while (bits == 0) {
+        if (++word == count) {
+            return count * kWordBits;
+        }
+        bits = words[word];
+    }
+    return word * kWordBits + std::countr_zero(bits);
+}
+
+inline void And(Word* dest, const Word* source, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] &= source[i];
+    }
+}
+
+inline void Or(Word* dest, const Word* source, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] |= source[i];
+    }
+}
+
+inline void Xor(Word* dest, const Word* source, size_t count) noexcept {
+    for (size_t i = 0; i < count; ++i) {
+        dest[i] ^= source[i];
+    }
+}
+
+}  // namespace bit_kernels
+
+// Proxy reference to one bit of a SimpleBitVector
+class BitReference {
+public:
+    using Word = bit_kernels::Word;
+
+    BitReference(Word* word, Word mask) noexcept
+        : word_(word)
+        , mask_(mask) {
+    }
+
+    BitReference(const BitReference&) noexcept = default;
+
+    operator bool() const noexcept {
+        return (*word_ & mask_) != 0;
+    }
+
+    const BitReference& operator=(bool value) const noexcept {
+        if (value) {
+            *word_ |= mask_;
+        } else {
+            *word_ &= ~mask_;
+        }
+        return *this;
+    }
+
+    const BitReference& operator=(const BitReference& other) const noexcept {
+        return *this = static_cast<bool>(other);
+    }
+
+    void Flip() const noexcept {
+        *word_ ^= mask_;
+    }
+
+private:
+    Word* word_;
+    Word mask_;
+};
+
+// Vector of bits packed 64 to a word. Words are kept in a SimpleVector, so capacity grows
+// by GrowthPolicy in whole words; bits past GetSize() in the last word are always zero,
+// which lets Count, comparisons and the bitwise operators work on whole words.
+template <typename Allocator = std::allocator<bit_kernels::Word>, typename GrowthPolicy = DoublingGrowth>
+class SimpleBitVector {
+public:
+    using Word = bit_kernels::Word;
+    using Reference = BitReference;
+    using allocator_type = Allocator;
+
+    static constexpr size_t kWordBits = bit_kernels::kWordBits;
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    SimpleBitVector() noexcept = default;
+
+    explicit SimpleBitVector(const Allocator& alloc) noexcept
+        : words_(alloc) {
+    }
+
+    explicit SimpleBitVector(size_t size, bool value = false, const Allocator& alloc = Allocator())
+        : words_(WordCount(size), value ? ~Word{0} : Word{0}, alloc)
+        , size_(size) {
+        ClearTail();
+    }
+
+    SimpleBitVector(std::initializer_list<bool> init, const Allocator& alloc = Allocator())
+        : words_(alloc) {
+        Reserve(init.size());
+        for (bool bit : init) {
+            PushBack(bit);
+        }
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return words_.GetAllocator();
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return words_.GetCapacity() * kWordBits;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Reference(&words_[index / kWordBits], Mask(index));
+    }
+
+    bool operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return (words_[index / kWordBits] & Mask(index)) != 0;
+    }
+
+    Reference At(size_t index) {
+        CheckIndex(index);
+        return (*this)[index];
+    }
+
+    bool At(size_t index) const {
+        CheckIndex(index);
+        return (*this)[index];
+    }
+
+    void Set(size_t index, bool value = true) noexcept {
+        (*this)[index] = value;
+    }
+
+    void Reset(size_t index) noexcept {
+        (*this)[index] = false;
+    }
+
+    void Flip(size_t index) noexcept {
+        (*this)[index].Flip();
+    }
+
+    void PushBack(bool value) {
+        if (size_ % kWordBits == 0) {
+            words_.PushBack(Word{0});
+        }
+        words_[size_ / kWordBits] |= Word{value} << (size_ % kWordBits);
+        ++size_;
+    }
+
+    // Appends the count low bits of bits, least significant first
+    void PushBackWord(Word bits, size_t count = kWordBits) {
+        assert(count <= kWordBits);
+        if (count == 0) {
+            return;
+        }
+        if (count < kWordBits) {
+            bits &= (Word{1} << count) - 1;
+        }
+        const size_t offset = size_ % kWordBits;
+        if (offset == 0) {
+            words_.PushBack(bits);
+        } else {
+            words_[size_ / kWordBits] |= bits << offset;
+            if (offset + count > kWordBits) {
+                words_.PushBack(bits >> (kWordBits - offset));
+            }
+        }
+        size_ += count;
+    }
+
+    void PopBack() noexcept {
+        if (!IsEmpty()) {
+            Resize(size_ - 1);
+        }
+    }
+
+    // New bits are set to value; whole words are filled at once
+    void Resize(size_t new_size, bool value = false) {
+        const size_t old_size = size_;
+        words_.Resize(WordCount(new_size));
+        size_ = new_size;
+        if (new_size > old_size && value) {
+            if (old_size % kWordBits != 0) {
+                words_[old_size / kWordBits] |= ~Word{0} << (old_size % kWordBits);
+            }
+            std::fill(words_.begin() + WordCount(old_size), words_.end(), ~Word{0});
+        }
+        ClearTail();
+    }
+
+    void Reserve(size_t new_capacity) {
+        words_.Reserve(WordCount(new_capacity));
+    }
+
+    void ShrinkToFit() {
+        words_.ShrinkToFit();
+    }
+
+    void Clear() noexcept {
+        words_.Clear();
+        size_ = 0;
+    }
+
+    void swap(SimpleBitVector& other) noexcept {
+        words_.swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+    // Number of set bits
+    size_t Count() const noexcept {
+        return bit_kernels::Count(words_.cbegin(), words_.GetSize());
+    }
+
+    bool Any() const noexcept {
+        return FindFirst() != npos;
+    }
+
+    bool None() const noexcept {
+        return !Any();
+    }
+
+    bool All() const noexcept {
+        return Count() == size_;
+    }
+
+    // Index of the first set bit, npos if there is none
+    size_t FindFirst() const noexcept {
+        return FindNext(0);
+    }
+
+    // Index of the first set bit at or after index, npos if there is none
+    size_t FindNext(size_t index) const noexcept {
+        const size_t found = bit_kernels::FindSet(words_.cbegin(), words_.GetSize(), index);
+        return found < size_ ? found : npos;
+    }
+
+    // Calls f(index) for every set bit in increasing order
+    template <typename Function>
+    void ForEachSet(Function f) const {
+        for (size_t word = 0; word < words_.GetSize(); ++word) {
+            for (Word bits = words_[word]; bits != 0; bits &= bits - 1) {
+                f(word * kWordBits + std::countr_zero(bits));
+            }
+        }
+    }
+
+    // The bitwise operators require vectors of equal size
+
+    SimpleBitVector& operator&=(const SimpleBitVector& other) noexcept {
+        assert(size_ == other.size_);
+        bit_kernels::And(words_.begin(), other.words_.cbegin(), words_.GetSize());
+        return *this;
+    }
+
+    SimpleBitVector& operator|=(const SimpleBitVector& other) noexcept {
+        assert(size_ == other.size_);
+        bit_kernels::Or(words_.begin(), other.words_.cbegin(), words_.GetSize());
+        return *this;
+    }
+
+    SimpleBitVector& operator^=(const SimpleBitVector& other) noexcept {
+        assert(size_ == other.size_);
+        bit_kernels::Xor(words_.begin(), other.words_.cbegin(), words_.GetSize());
+        return *this;
+    }
+
+    // Inverts every bit
+    void FlipAll() noexcept {
+        for (Word& word : words_) {
+            word = ~word;
+        }
+        ClearTail();
+    }
+
+    // The packed words, bit i is bit i % 64 of word i / 64
+    SimpleVectorView<const Word> Words() const noexcept {
+        return SimpleVectorView<const Word>(words_.cbegin(), words_.GetSize());
+    }
+
+    friend bool operator==(const SimpleBitVector& lhs, const SimpleBitVector& rhs) {
+        return lhs.size_ == rhs.size_ && lhs.words_ == rhs.words_;
+    }
+
+private:
+    static size_t WordCount(size_t bits) noexcept {
+        return (bits + kWordBits - 1) / kWordBits;
+    }
+
+    static Word Mask(size_t index) noexcept {
+        return Word{1} << (index % kWordBits);
+    }
+
+    void CheckIndex(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+    }
+
+    void ClearTail() noexcept {
+        if (size_ % kWordBits != 0) {
+            words_[size_ / kWordBits] &= (Word{1} << (size_ % kWordBits)) - 1;
+        }
+    }
+
+    SimpleVector<Word, Allocator, GrowthPolicy> words_;
+    size_t size_ = 0;
+};
+
+template <typename Allocator, typename GrowthPolicy>
+inline SimpleBitVector<Allocator, GrowthPolicy> operator&(SimpleBitVector<Allocator, GrowthPolicy> lhs,
+                                                          const SimpleBitVector<Allocator, GrowthPolicy>& rhs) {
+    lhs &= rhs;
+    return lhs;
+}
+
+template <typename Allocator, typename GrowthPolicy>
+inline SimpleBitVector<Allocator, GrowthPolicy> operator|(SimpleBitVector<Allocator, GrowthPolicy> lhs,
+                                                          const SimpleBitVector<Allocator, GrowthPolicy>& rhs) {
+    lhs |= rhs;
+    return lhs;
+}
+
+template <typename Allocator, typename GrowthPolicy>
+inline SimpleBitVector<Allocator, GrowthPolicy> operator^(SimpleBitVector<Allocator, GrowthPolicy> lhs,
+                                                          const SimpleBitVector<Allocator, GrowthPolicy>& rhs) {
+    lhs ^= rhs;
+    return lhs;
+}
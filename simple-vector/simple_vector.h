@@ -5,7 +5,16 @@
 #include <algorithm>
 #include <stdexcept>
 #include <compare>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 #include "array_ptr.h"
+#include "element_ops.h"
+#include "growth_policy.h"
+#include "vector_kernels.h"
 
 struct ReserveProxyObj {
     explicit ReserveProxyObj(size_t capacity_to_reserve) : capacity(capacity_to_reserve) {
@@ -17,133 +26,421 @@ ReserveProxyObj Reserve(size_t capacity_to_reserve) {
     return ReserveProxyObj(capacity_to_reserve);
 }
 
-template <typename Type>
+struct FromRangeTag {
+    explicit FromRangeTag() = default;
+};
+
+inline constexpr FromRangeTag from_range{};
+
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
 class SimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static constexpr bool kUninitializedResize = std::is_trivially_copyable_v<Type>
+        && std::is_trivially_destructible_v<Type> && ElementOps<Type, Allocator>::kPlainConstruct
+        && ElementOps<Type, Allocator>::kPlainDestroy;
+
 public:
     using Iterator = Type*;
     using ConstIterator = const Type*;
+    using allocator_type = Allocator;
 
     SimpleVector() noexcept = default;
 
-    explicit SimpleVector(size_t size)
-        : items_(size)
-        , size_(size)
+    explicit SimpleVector(const Allocator& alloc) noexcept
+        : items_(alloc) {
+    }
+
+    explicit SimpleVector(size_t size, const Allocator& alloc = Allocator())
+        : items_(size, uninitialized, alloc)
         , capacity_(size) {
-        std::generate(begin(), end(), []{ 
-            return Type{}; 
-            });
+        Ops().UninitializedConstruct(items_.GetRawPtr(), size);
+        size_ = size;
     }
 
-    SimpleVector(size_t size, const Type& value)
-        : items_(size)  
-        , size_(size)
+    SimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : items_(size, uninitialized, alloc)
+        , capacity_(size) {
+        Ops().UninitializedConstruct(items_.GetRawPtr(), size, value);
+        size_ = size;
+    }
+
+    // Sized constructors that construct the elements in parallel chunks on executor,
+    // e.g. SimpleVector<int>(DefaultThreadPool(), 10'000'000)
+    template <ParallelExecutor Executor>
+    SimpleVector(Executor& executor, size_t size, const Allocator& alloc = Allocator())
+        : items_(size, uninitialized, alloc)
         , capacity_(size) {
-        std::fill(begin(), end(), value);
+        Ops().ParallelUninitializedConstruct(executor, items_.GetRawPtr(), size);
+        size_ = size;
     }
 
-    SimpleVector(std::initializer_list<Type> init)
-        : items_(init.size())
-        , size_(init.size())
+    template <ParallelExecutor Executor>
+    SimpleVector(Executor& executor, size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : items_(size, uninitialized, alloc)
+        , capacity_(size) {
+        Ops().ParallelUninitializedConstruct(executor, items_.GetRawPtr(), size, value);
+        size_ = size;
+    }
+
+    SimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+        : items_(init.size(), uninitialized, alloc)
         , capacity_(init.size()) {
-        std::copy(init.begin(), init.end(), this->begin());
+        Ops().UninitializedCopy(init.begin(), init.end(), items_.GetRawPtr());
+        size_ = init.size();
+    }
+
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    SimpleVector(InputIt first, Sentinel last, const Allocator& alloc = Allocator())
+        : SimpleVector(alloc) {
+        Append(std::move(first), std::move(last));
+    }
+
+    template <std::ranges::input_range Range>
+    SimpleVector(FromRangeTag, Range&& range, const Allocator& alloc = Allocator())
+        : SimpleVector(alloc) {
+        Append(std::forward<Range>(range));
     }
 
-    SimpleVector(ReserveProxyObj reserved)
-        : items_(reserved.capacity)
+    SimpleVector(ReserveProxyObj reserved, const Allocator& alloc = Allocator())
+        : items_(reserved.capacity, uninitialized, alloc)
         , size_(0)
         , capacity_(reserved.capacity) {
     }
 
+    // Adopts raw storage whose first size objects are already constructed
+    SimpleVector(ArrayPtr<Type, Allocator>&& storage, size_t size) noexcept
+        : items_(std::move(storage))
+        , size_(size)
+        , capacity_(items_.GetSize()) {
+        assert(items_.IsRaw() || !items_);
+        assert(size_ <= capacity_);
+    }
+
     SimpleVector(const SimpleVector& other)
-        : items_(other.size_)
-        , size_(other.size_)
+        : SimpleVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    SimpleVector(const SimpleVector& other, const Allocator& alloc)
+        : items_(other.size_, uninitialized, alloc)
         , capacity_(other.size_) {
-        std::copy(other.begin(), other.end(), this->begin());
+        Ops().UninitializedCopy(other.begin(), other.end(), items_.GetRawPtr());
+        size_ = other.size_;
     }
 
-    SimpleVector(SimpleVector&& other)
+    // Copy constructor whose element copies are split across executor, streaming for large
+    // trivially copyable buffers
+    template <ParallelExecutor Executor>
+    SimpleVector(Executor& executor, const SimpleVector& other)
+        : SimpleVector(executor, other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    template <ParallelExecutor Executor>
+    SimpleVector(Executor& executor, const SimpleVector& other, const Allocator& alloc)
+        : items_(other.size_, uninitialized, alloc)
+        , capacity_(other.size_) {
+        Ops().ParallelUninitializedCopy(executor, other.begin(), other.end(), items_.GetRawPtr());
+        size_ = other.size_;
+    }
+
+    SimpleVector(SimpleVector&& other) noexcept
         : items_(std::move(other.items_))
         , size_(std::exchange(other.size_, 0))
         , capacity_(std::exchange(other.capacity_, 0)) { 
         }
 
+    SimpleVector(SimpleVector&& other, const Allocator& alloc)
+        : items_(alloc) {
+        if (alloc == other.GetAllocator()) {
+            swap(other);
+        } else {
+            SimpleVector buffer(ReserveProxyObj(other.size_), alloc);
+            buffer.Ops().UninitializedMove(other.begin(), other.end(), buffer.begin());
+            buffer.size_ = other.size_;
+            swap(buffer);
+        }
+    }
+
+    ~SimpleVector() {
+        Ops().Destroy(begin(), end());
+    }
+
     SimpleVector& operator=(const SimpleVector& other) {
         if (&other != this) {
-            if (other.IsEmpty()) {
-                Clear();
-                capacity_ = 0;
-                items_ = ArrayPtr<Type>();
-            } else {
-                SimpleVector other_copy(other);
-                swap(other_copy);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != other.GetAllocator()) {
+                    DestroyElements();
+                    items_ = ArrayPtr<Type, Allocator>(other.GetAllocator());
+                    capacity_ = 0;
+                }
             }
+            SimpleVector other_copy(other, GetAllocator());
+            swap(other_copy);
         }
         return *this;
     }
 
-    SimpleVector& operator=(SimpleVector&& other) {
+    SimpleVector& operator=(SimpleVector&& other) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
         if (this != &other) {
-            swap(other);
+            if (AllocTraits::propagate_on_container_move_assignment::value
+                || GetAllocator() == other.GetAllocator()) {
+                DestroyElements();
+                items_ = std::move(other.items_);
+                size_ = std::exchange(other.size_, 0);
+                capacity_ = std::exchange(other.capacity_, 0);
+            } else {
+                // storage owned by a foreign allocator can't be adopted, move the elements instead
+                SimpleVector buffer(std::move(other), GetAllocator());
+                swap(buffer);
+            }
         }
         return *this;
     }
 
+    Allocator GetAllocator() const noexcept {
+        return items_.GetAllocator();
+    }
+
     void PushBack(const Type& item) {
-        if (IsFull()) {
-            IncCapacity();
-        }
-        items_[size_++] = item;
+        EmplaceBack(item);
     }
 
     void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
         if (IsFull()) {
-            IncCapacity();
+            ReallocateAndEmplace(size_, std::forward<Args>(args)...);
+        } else {
+            Ops().ConstructAt(end(), std::forward<Args>(args)...);
+            ++size_;
         }
-        items_[size_++] = std::move(item);
+        return items_[size_ - 1];
     }
 
-    Iterator Insert(ConstIterator pos, const Type& value) {
-        assert(begin() <= pos && pos <= end());
-        size_t offset = std::distance(cbegin(), pos);
-
-        if (IsFull()) {
-            IncCapacity();
+    // Reserves once for forward ranges; the range may refer to elements of this vector
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    void Append(InputIt first, Sentinel last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            const size_t count = std::ranges::distance(first, last);
+            if (size_ + count > capacity_) {
+                ReallocateWithGap(NewCapacity(size_ + count), size_, count, [&](Type* gap) {
+                    Ops().UninitializedCopy(std::move(first), std::move(last), gap);
+                });
+            } else {
+                Ops().UninitializedCopy(std::move(first), std::move(last), end());
+                size_ += count;
+            }
+        } else {
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
         }
+    }
+
+    template <std::ranges::input_range Range>
+    void Append(Range&& range) {
+        Append(std::ranges::begin(range), std::ranges::end(range));
+    }
+
+    // Appends to capacity reserved beforehand, without the growth check; running past the
+    // capacity is caught by assert only
+    void PushBackUnchecked(const Type& item) {
+        EmplaceBackUnchecked(item);
+    }
+
+    void PushBackUnchecked(Type&& item) {
+        EmplaceBackUnchecked(std::move(item));
+    }
 
+    template <typename... Args>
+    Type& EmplaceBackUnchecked(Args&&... args) {
+        assert(!IsFull());
+        Type* slot = items_.GetRawPtr() + size_;
+        Ops().ConstructAt(slot, std::forward<Args>(args)...);
         ++size_;
-        Iterator  it = begin() + offset;
-        std::copy_backward(it, end() - 1, end());
-        *it = value;
-        return it;
+        return *slot;
+    }
+
+    // Grows the size by count without initializing the new elements and returns a pointer to
+    // the first of them, which the caller must write before reading. Only for trivially
+    // copyable types, whose objects come to life as their bytes are written.
+    Type* AppendUninitialized(size_t count) requires kUninitializedResize {
+        const size_t new_size = size_ + count;
+        if (new_size > capacity_) {
+            Reallocate(NewCapacity(new_size));
+        }
+        Type* first = end();
+        size_ = new_size;
+        return first;
+    }
+
+    // Lowers the size to new_size and keeps the capacity whatever the GrowthPolicy, to give
+    // back the end of an AppendUninitialized that was not written
+    void TruncateUninitialized(size_t new_size) noexcept requires kUninitializedResize {
+        assert(new_size <= size_);
+        size_ = new_size;
+    }
+
+    // Resize leaving new elements uninitialized, see AppendUninitialized; returns begin()
+    Type* ResizeUninitialized(size_t new_size) requires kUninitializedResize {
+        if (new_size > size_) {
+            AppendUninitialized(new_size - size_);
+        } else {
+            size_ = new_size;
+            MaybeShrink();
+        }
+        return begin();
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
     }
 
     Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
         assert(begin() <= pos && pos <= end());
-        size_t offset = std::distance(cbegin(), pos);
+        const size_t offset = std::distance(cbegin(), pos);
 
         if (IsFull()) {
-            IncCapacity();
+            ReallocateAndEmplace(offset, std::forward<Args>(args)...);
+        } else if (offset == size_) {
+            Ops().ConstructAt(end(), std::forward<Args>(args)...);
+            ++size_;
+        } else {
+            // args may refer to elements of this vector, so build the value before shifting
+            Type value(std::forward<Args>(args)...);
+            VectorEvents<Type>::Shift(size_ - offset);
+            Ops().ConstructAt(end(), std::move(*(end() - 1)));
+            ++size_;
+            std::move_backward(begin() + offset, end() - 2, end() - 1);
+            items_[offset] = std::move(value);
         }
+        return begin() + offset;
+    }
 
-        ++size_;
-        Iterator  it = begin() + offset;
-        std::copy_backward(std::make_move_iterator(it), std::make_move_iterator(end() - 1), end());
-        *it = std::move(value);
-        return it;
+    // Inserts [first, last) before pos shifting the tail only once.
+    // Unless the vector reallocates, the range must not refer to its elements.
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    Iterator InsertRange(ConstIterator pos, InputIt first, Sentinel last) {
+        assert(begin() <= pos && pos <= end());
+        const size_t offset = std::distance(cbegin(), pos);
+
+        if constexpr (!std::forward_iterator<InputIt>) {
+            const size_t old_size = size_;
+            Append(std::move(first), std::move(last));
+            std::rotate(begin() + offset, begin() + old_size, end());
+        } else {
+            const size_t count = std::ranges::distance(first, last);
+            if (size_ + count > capacity_) {
+                ReallocateWithGap(NewCapacity(size_ + count), offset, count, [&](Type* gap) {
+                    Ops().UninitializedCopy(std::move(first), std::move(last), gap);
+                });
+            } else if (count > 0) {
+                InsertRangeInPlace(offset, count, std::move(first), std::move(last));
+            }
+        }
+        return begin() + offset;
     }
 
     void PopBack() noexcept {
         if (!IsEmpty()) {
             --size_;
+            Ops().DestroyAt(end());
+            MaybeShrink();
         }
     }
 
     Iterator Erase(ConstIterator pos) {
         assert(begin() <= pos && pos < end());
-        Iterator erase_pos = const_cast<Iterator>(pos);
-        std::move(erase_pos + 1, end(), erase_pos);
-        --size_;
-        return erase_pos;
+        return EraseRange(pos, pos + 1);
+    }
+
+    Iterator EraseRange(ConstIterator first, ConstIterator last) {
+        assert(begin() <= first && first <= last && last <= end());
+        const size_t offset = std::distance(cbegin(), first);
+        const size_t count = std::distance(first, last);
+        if (count > 0) {
+            Iterator erase_pos = begin() + offset;
+            if (erase_pos + count != end()) {
+                VectorEvents<Type>::Shift(end() - erase_pos - count);
+            }
+            if constexpr (IsTriviallyRelocatable<Type>::value) {
+                Ops().Destroy(erase_pos, erase_pos + count);
+                std::memmove(static_cast<void*>(erase_pos), static_cast<const void*>(erase_pos + count),
+                             (end() - erase_pos - count) * sizeof(Type));
+            } else {
+                Iterator new_end = std::move(erase_pos + count, end(), erase_pos);
+                Ops().Destroy(new_end, end());
+            }
+            size_ -= count;
+            MaybeShrink();
+        }
+        return begin() + offset;
+    }
+
+    // Removes every element satisfying pred in a single compacting pass, returns the number removed
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        Iterator new_end = std::remove_if(begin(), end(), pred);
+        const size_t removed = std::distance(new_end, end());
+        Ops().Destroy(new_end, end());
+        size_ -= removed;
+        MaybeShrink();
+        return removed;
+    }
+
+    // O(1) erase for callers that don't need the order: the last element is moved into pos.
+    // Returns pos, which now holds that element, or end() if pos was the last one.
+    Iterator UnorderedErase(ConstIterator pos) {
+        assert(begin() <= pos && pos < end());
+        const size_t offset = std::distance(cbegin(), pos);
+        SwapRemove(offset);
+        return begin() + offset;
+    }
+
+    void SwapRemove(size_t index) {
+        assert(index < size_);
+        if (index + 1 != size_) {
+            items_[index] = std::move(items_[size_ - 1]);
+        }
+        PopBack();
+    }
+
+    // EraseIf that fills each hole with an element from the back instead of shifting the
+    // rest down, so it moves at most as many elements as it removes. Order is not kept.
+    template <typename Predicate>
+    size_t UnorderedEraseIf(Predicate pred) {
+        Iterator first = begin();
+        Iterator last = end();
+        while (true) {
+            while (first != last && !pred(std::as_const(*first))) {
+                ++first;
+            }
+            if (first == last) {
+                break;
+            }
+            do {
+                --last;
+            } while (first != last && pred(std::as_const(*last)));
+            if (first == last) {
+                break;
+            }
+            *first = std::move(*last);
+            ++first;
+        }
+        const size_t removed = std::distance(first, end());
+        Ops().Destroy(first, end());
+        size_ -= removed;
+        MaybeShrink();
+        return removed;
     }
 
     void swap(SimpleVector& other) noexcept {
@@ -193,33 +490,35 @@ public:
     }
 
     void Clear() noexcept {
-        size_ = 0;
+        DestroyElements();
+        MaybeShrink();
     }
 
     void Resize(size_t new_size) {
         if (new_size > capacity_) {
-            const size_t new_capacity = NewCapacity(new_size);
-            SimpleVector<Type> buffer(new_capacity);
-            std::move(begin(), end(), buffer.begin());
-            swap(buffer);
+            Reallocate(NewCapacity(new_size));
         }
-        else if (new_size > size_) {
-            assert(new_size <= capacity_);
-            std::generate(end(), begin() + new_size, [] {
-                return Type{};
-                });
+        if (new_size > size_) {
+            Ops().UninitializedConstruct(end(), new_size - size_);
+        } else {
+            Ops().Destroy(begin() + new_size, end());
         }
         size_ = new_size;
+        MaybeShrink();
     }
 
     void Reserve(size_t new_capacity) {
         if (new_capacity > capacity_) {
-            size_t size_save = size_;
-            Resize(new_capacity);
-            size_ = size_save;
-            capacity_ = new_capacity;
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Reallocates into a buffer of exactly GetSize() elements, releasing an empty buffer entirely
+    void ShrinkToFit() {
+        if (capacity_ > size_) {
+            Reallocate(size_);
         }
-    };
+    }
 
     Iterator begin() noexcept {
         return items_.GetRawPtr();
@@ -246,56 +545,160 @@ public:
     }
 
 private:
-    void IncCapacity() {
-        SimpleVector<Type> buffer(NewCapacity());
-        buffer.size_ = size_;
-        std::move(begin(), end(), buffer.begin());
-        swap(buffer);
+    template <typename... Args>
+    void ReallocateAndEmplace(size_t offset, Args&&... args) {
+        ReallocateWithGap(NewCapacity(size_ + 1), offset, 1, [&](Type* gap) {
+            Ops().ConstructAt(gap, std::forward<Args>(args)...);
+        });
+    }
+
+    // Moves the elements into a new buffer leaving count slots at offset, which fill_gap
+    // constructs (or rolls back on failure) before the old buffer is released, so the
+    // new elements may be built from references into this vector.
+    template <typename FillGap>
+    void ReallocateWithGap(size_t new_capacity, size_t offset, size_t count, FillGap&& fill_gap) {
+        ArrayPtr<Type, Allocator> buffer(new_capacity, uninitialized, items_.GetAllocator());
+        Type* new_items = buffer.GetRawPtr();
+        fill_gap(new_items + offset);
+        try {
+            Ops().UninitializedTransfer(begin(), begin() + offset, new_items);
+            try {
+                Ops().UninitializedTransfer(begin() + offset, end(), new_items + offset + count);
+            } catch (...) {
+                Ops().Destroy(new_items, new_items + offset);
+                throw;
+            }
+        } catch (...) {
+            Ops().Destroy(new_items + offset, new_items + offset + count);
+            throw;
+        }
+        Ops().DestroyTransferred(begin(), end());
+        items_.swap(buffer);
+        capacity_ = new_capacity;
+        size_ += count;
+        VectorEvents<Type>::Reallocation();
+    }
+
+    template <typename ForwardIt, typename Sentinel>
+    void InsertRangeInPlace(size_t offset, size_t count, ForwardIt first, Sentinel last) {
+        Type* position = begin() + offset;
+        Type* old_end = end();
+        const size_t elements_after = size_ - offset;
+        if (elements_after > 0) {
+            VectorEvents<Type>::Shift(elements_after);
+        }
+
+        if constexpr (IsTriviallyRelocatable<Type>::value) {
+            const size_t tail_bytes = elements_after * sizeof(Type);
+            std::memmove(static_cast<void*>(position + count), static_cast<const void*>(position), tail_bytes);
+            try {
+                Ops().UninitializedCopy(std::move(first), std::move(last), position);
+            } catch (...) {
+                std::memmove(static_cast<void*>(position), static_cast<const void*>(position + count), tail_bytes);
+                throw;
+            }
+            size_ += count;
+        } else if (elements_after > count) {
+            Ops().UninitializedMove(old_end - count, old_end, old_end);
+            size_ += count;
+            std::move_backward(position, old_end - count, old_end);
+            std::ranges::copy(std::move(first), std::move(last), position);
+        } else {
+            ForwardIt mid = std::ranges::next(first, elements_after);
+            Ops().UninitializedCopy(mid, std::move(last), old_end);
+            size_ += count - elements_after;
+            Ops().UninitializedMove(position, old_end, end());
+            size_ += elements_after;
+            std::ranges::copy(std::move(first), std::move(mid), position);
+        }
+    }
+
+    void Reallocate(size_t new_capacity) {
+        ArrayPtr<Type, Allocator> buffer(new_capacity, uninitialized, items_.GetAllocator());
+        Ops().UninitializedTransfer(begin(), end(), buffer.GetRawPtr());
+        Ops().DestroyTransferred(begin(), end());
+        items_.swap(buffer);
+        capacity_ = new_capacity;
+        VectorEvents<Type>::Reallocation();
+    }
+
+    void DestroyElements() noexcept {
+        Ops().Destroy(begin(), end());
+        size_ = 0;
     }
 
-    size_t NewCapacity(const size_t new_size = 1) {
-        return std::max(capacity_ * 2, new_size);
+    // Growth policies providing ShrinkCapacity give memory back as the vector empties.
+    // Shrinking is an optimization, so a failed reallocation keeps the current buffer. That
+    // needs a relocation that either cannot throw or copies, leaving the source intact; a
+    // throwing move could fail halfway, so such types are never shrunk automatically.
+    void MaybeShrink() noexcept {
+        constexpr bool kIntactOnFailure = IsTriviallyRelocatable<Type>::value
+                                          || std::is_nothrow_move_constructible_v<Type>
+                                          || std::is_copy_constructible_v<Type>;
+        if constexpr (kIntactOnFailure && requires { GrowthPolicy::ShrinkCapacity(capacity_, size_); }) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(capacity_, size_);
+            if (new_capacity < capacity_) {
+                try {
+                    Reallocate(new_capacity);
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    ElementOps<Type, Allocator> Ops() noexcept {
+        return ElementOps<Type, Allocator>(items_.GetAllocator());
+    }
+
+    size_t NewCapacity(size_t required) const {
+        return GrowthPolicy::NewCapacity(capacity_, required, sizeof(Type));
     }
 
 private:
-    ArrayPtr<Type> items_;
+    ArrayPtr<Type, Allocator> items_;
     size_t size_ = 0;
     size_t capacity_ = 0;
 };
 
-template <typename Type>
-inline std::strong_ordering operator<=>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return std::lexicographical_compare_three_way(
-        lhs.cbegin(), lhs.cend(),
-        rhs.cbegin(), rhs.cend());
+// The vector itself is a pointer and two sizes; with a stateless allocator that carries
+// nothing tied to the object's address it can be moved around with memcpy. Specialize for
+// stateful allocators known to be safe.
+template <typename Type, typename Allocator, typename GrowthPolicy>
+struct IsTriviallyRelocatable<SimpleVector<Type, Allocator, GrowthPolicy>>
+    : std::bool_constant<std::is_empty_v<Allocator> && std::allocator_traits<Allocator>::is_always_equal::value> {
+};
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline std::compare_three_way_result_t<Type> operator<=>(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return vector_kernels::Compare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize());
 }
 
-template <typename Type>
-inline bool operator==(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (lhs <=> rhs) == std::strong_ordering::equal;
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator==(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && vector_kernels::Equal(lhs.cbegin(), rhs.cbegin(), lhs.GetSize());
 }
 
-template <typename Type>
-inline bool operator!=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (lhs <=> rhs) != std::strong_ordering::equal;
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator!=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
 }
 
-template <typename Type>
-inline bool operator<(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (lhs <=> rhs) == std::strong_ordering::less;
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator<(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) < 0;
 }
 
-template <typename Type>
-inline bool operator<=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (lhs <=> rhs) != std::strong_ordering::greater;
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator<=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) <= 0;
 }
 
-template <typename Type>
-inline bool operator>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (lhs <=> rhs) == std::strong_ordering::greater;
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator>(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) > 0;
 }
 
-template <typename Type>
-inline bool operator>=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return (lhs <=> rhs) != std::strong_ordering::less;
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator>=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) >= 0;
 }
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include "array_ptr.h"
+#include "vector_kernels.h"
+
+template <typename Type>
+class SimpleVectorView;
+
+namespace vector_view {
+
+// SimpleVectorView<T> and SimpleVectorView<const T> share this base, so argument-dependent
+// lookup finds one set of comparisons for both, and anything convertible to a read-only
+// view (temporaries included) compares with either.
+template <typename Value>
+class Comparisons {
+    using View = SimpleVectorView<const Value>;
+
+public:
+    // Constrained, so views of elements without these operators can still be formed
+    friend auto operator<=>(View lhs, View rhs) requires std::three_way_comparable<Value> {
+        return vector_kernels::Compare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize());
+    }
+
+    friend bool operator==(View lhs, View rhs) requires std::equality_comparable<Value> {
+        return lhs.GetSize() == rhs.GetSize() && vector_kernels::Equal(lhs.cbegin(), rhs.cbegin(), lhs.GetSize());
+    }
+};
+
+}  // namespace vector_view
+
+// Non-owning pointer and size over contiguous elements. Every contiguous container converts
+// to it implicitly: SimpleVector, SmallSimpleVector, MappedSimpleVector, std::vector.
+// Use SimpleVectorView<const T> for read-only slices; a view of mutable elements binds
+// to lvalues only, so it can't be made from a temporary that is about to go away.
+template <typename Type>
+class SimpleVectorView : public vector_view::Comparisons<std::remove_cv_t<Type>> {
+    template <typename Range>
+    static constexpr bool kCompatibleRange =
+        std::ranges::contiguous_range<Range> && std::ranges::sized_range<Range>
+        && std::is_convertible_v<std::remove_reference_t<std::ranges::range_reference_t<Range>> (*)[], Type (*)[]>
+        && (std::is_const_v<Type> || std::is_lvalue_reference_v<Range>);
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using value_type = std::remove_cv_t<Type>;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    constexpr SimpleVectorView() noexcept = default;
+
+    constexpr SimpleVectorView(Type* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    template <typename Range>
+        requires(kCompatibleRange<Range> && !std::is_same_v<std::remove_cvref_t<Range>, SimpleVectorView>)
+    constexpr SimpleVectorView(Range&& range) noexcept
+        : data_(std::ranges::data(range))
+        , size_(std::ranges::size(range)) {
+    }
+
+    // The first size objects of storage must be constructed
+    template <typename Element, typename Allocator>
+        requires std::is_convertible_v<Element (*)[], Type (*)[]>
+    SimpleVectorView(ArrayPtr<Element, Allocator>& storage, size_t size) noexcept
+        : data_(storage.GetRawPtr())
+        , size_(size) {
+    }
+
+    constexpr size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    constexpr bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr Type* Data() const noexcept {
+        return data_;
+    }
+
+    constexpr Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    constexpr Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return data_[index];
+    }
+
+    // count elements starting at offset, or all the rest; throws if offset is past the end
+    constexpr SimpleVectorView Subview(size_t offset, size_t count = npos) const {
+        if (offset > size_) {
+            throw std::out_of_range("Subview offset out of range");
+        }
+        return SimpleVectorView(data_ + offset, std::min(count, size_ - offset));
+    }
+
+    constexpr SimpleVectorView First(size_t count) const {
+        if (count > size_) {
+            throw std::out_of_range("Subview size out of range");
+        }
+        return SimpleVectorView(data_, count);
+    }
+
+    constexpr SimpleVectorView Last(size_t count) const {
+        if (count > size_) {
+            throw std::out_of_range("Subview size out of range");
+        }
+        return SimpleVectorView(data_ + (size_ - count), count);
+    }
+
+    constexpr Iterator begin() const noexcept {
+        return data_;
+    }
+
+    constexpr Iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    constexpr ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    constexpr ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename Range>
+SimpleVectorView(Range&&) -> SimpleVectorView<std::remove_reference_t<std::ranges::range_reference_t<Range>>>;
+
+template <typename Type>
+inline constexpr bool std::ranges::enable_borrowed_range<SimpleVectorView<Type>> = true;
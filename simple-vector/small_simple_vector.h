@@ -0,0 +1,410 @@
+#pragma once
+
+#include <cassert>
+#include <initializer_list>
+#include <algorithm>
+#include <stdexcept>
+#include <compare>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "simple_vector.h"
+
+// SimpleVector that keeps up to N elements in an inline buffer and only
+// allocates from Allocator once it grows past that.
+template <typename Type, size_t N, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+class SmallSimpleVector {
+    static_assert(N > 0);
+    static_assert(!requires { GrowthPolicy::ShrinkCapacity(size_t{}, size_t{}); },
+                  "SmallSimpleVector does not shrink automatically, use ShrinkToFit");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using allocator_type = Allocator;
+
+    SmallSimpleVector() noexcept = default;
+
+    explicit SmallSimpleVector(const Allocator& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    explicit SmallSimpleVector(size_t size, const Allocator& alloc = Allocator())
+        : heap_(alloc) {
+        Reserve(size);
+        Ops().UninitializedConstruct(Data(), size);
+        size_ = size;
+    }
+
+    SmallSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+        : heap_(alloc) {
+        Reserve(size);
+        Ops().UninitializedConstruct(Data(), size, value);
+        size_ = size;
+    }
+
+    SmallSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+        : heap_(alloc) {
+        Reserve(init.size());
+        Ops().UninitializedCopy(init.begin(), init.end(), Data());
+        size_ = init.size();
+    }
+
+    SmallSimpleVector(ReserveProxyObj reserved, const Allocator& alloc = Allocator())
+        : heap_(alloc) {
+        Reserve(reserved.capacity);
+    }
+
+    SmallSimpleVector(const SmallSimpleVector& other)
+        : SmallSimpleVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+    }
+
+    SmallSimpleVector(const SmallSimpleVector& other, const Allocator& alloc)
+        : heap_(alloc) {
+        Reserve(other.size_);
+        Ops().UninitializedCopy(other.begin(), other.end(), Data());
+        size_ = other.size_;
+    }
+
+    SmallSimpleVector(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>)
+        : heap_(other.heap_.GetAllocator()) {
+        TakeFrom(other);
+    }
+
+    ~SmallSimpleVector() {
+        Ops().Destroy(begin(), end());
+    }
+
+    SmallSimpleVector& operator=(const SmallSimpleVector& other) {
+        if (&other != this) {
+            SmallSimpleVector other_copy(other, GetAllocator());
+            *this = std::move(other_copy);
+        }
+        return *this;
+    }
+
+    SmallSimpleVector& operator=(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if (this != &other) {
+            Clear();
+            TakeFrom(other);
+        }
+        return *this;
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (IsFull()) {
+            ReallocateAndEmplace(size_, std::forward<Args>(args)...);
+        } else {
+            Ops().ConstructAt(end(), std::forward<Args>(args)...);
+            ++size_;
+        }
+        return Data()[size_ - 1];
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        assert(begin() <= pos && pos <= end());
+        const size_t offset = std::distance(cbegin(), pos);
+
+        if (IsFull()) {
+            ReallocateAndEmplace(offset, std::forward<Args>(args)...);
+        } else if (offset == size_) {
+            Ops().ConstructAt(end(), std::forward<Args>(args)...);
+            ++size_;
+        } else {
+            // args may refer to elements of this vector, so build the value before shifting
+            Type value(std::forward<Args>(args)...);
+            VectorEvents<Type>::Shift(size_ - offset);
+            Ops().ConstructAt(end(), std::move(*(end() - 1)));
+            ++size_;
+            std::move_backward(begin() + offset, end() - 2, end() - 1);
+            Data()[offset] = std::move(value);
+        }
+        return begin() + offset;
+    }
+
+    void PopBack() noexcept {
+        if (!IsEmpty()) {
+            --size_;
+            Ops().DestroyAt(end());
+        }
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        assert(begin() <= pos && pos < end());
+        Iterator erase_pos = const_cast<Iterator>(pos);
+        if (erase_pos + 1 != end()) {
+            VectorEvents<Type>::Shift(end() - erase_pos - 1);
+        }
+        std::move(erase_pos + 1, end(), erase_pos);
+        --size_;
+        Ops().DestroyAt(end());
+        return erase_pos;
+    }
+
+    void swap(SmallSimpleVector& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.swap(other.heap_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+        } else {
+            SmallSimpleVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    bool IsFull() const noexcept {
+        return size_ == capacity_;
+    }
+
+    bool IsInline() const noexcept {
+        return !heap_;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return Data()[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return Data()[index];
+    }
+
+    void Clear() noexcept {
+        Ops().Destroy(begin(), end());
+        size_ = 0;
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size > capacity_) {
+            Reallocate(NewCapacity(new_size));
+        }
+        if (new_size > size_) {
+            Ops().UninitializedConstruct(end(), new_size - size_);
+        } else {
+            Ops().Destroy(begin() + new_size, end());
+        }
+        size_ = new_size;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    // Moves the elements back inline when they fit, otherwise into an exactly sized heap buffer
+    void ShrinkToFit() {
+        if (IsInline() || capacity_ == size_) {
+            return;
+        }
+        if (size_ <= N) {
+            Ops().UninitializedTransfer(begin(), end(), InlineData());
+            Ops().DestroyTransferred(heap_.GetRawPtr(), heap_.GetRawPtr() + size_);
+            ArrayPtr<Type, Allocator> empty(heap_.GetAllocator());
+            heap_.swap(empty);
+            capacity_ = N;
+        } else {
+            Reallocate(size_);
+        }
+    }
+
+    Iterator begin() noexcept {
+        return Data();
+    }
+
+    Iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return Data();
+    }
+
+    ConstIterator cend() const noexcept {
+        return Data() + size_;
+    }
+
+private:
+    Type* Data() noexcept {
+        return IsInline() ? InlineData() : heap_.GetRawPtr();
+    }
+
+    const Type* Data() const noexcept {
+        return IsInline() ? InlineData() : heap_.GetRawPtr();
+    }
+
+    Type* InlineData() noexcept {
+        return std::launder(reinterpret_cast<Type*>(inline_));
+    }
+
+    const Type* InlineData() const noexcept {
+        return std::launder(reinterpret_cast<const Type*>(inline_));
+    }
+
+    // Moves the contents of other into this empty vector. A heap buffer is adopted when
+    // the allocators allow it, inline elements are always relocated one by one.
+    void TakeFrom(SmallSimpleVector& other) {
+        assert(IsEmpty());
+        if (!other.IsInline()
+            && (AllocTraits::propagate_on_container_move_assignment::value
+                || GetAllocator() == other.GetAllocator())) {
+            heap_ = std::move(other.heap_);
+            capacity_ = std::exchange(other.capacity_, N);
+        } else {
+            Reserve(other.size_);
+            Ops().UninitializedTransfer(other.begin(), other.end(), Data());
+            other.Ops().DestroyTransferred(other.begin(), other.end());
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    template <typename... Args>
+    void ReallocateAndEmplace(size_t offset, Args&&... args) {
+        const size_t new_capacity = NewCapacity(size_ + 1);
+        ArrayPtr<Type, Allocator> buffer(new_capacity, uninitialized, heap_.GetAllocator());
+        Type* new_items = buffer.GetRawPtr();
+        Ops().ConstructAt(new_items + offset, std::forward<Args>(args)...);
+        try {
+            Ops().UninitializedTransfer(begin(), begin() + offset, new_items);
+            try {
+                Ops().UninitializedTransfer(begin() + offset, end(), new_items + offset + 1);
+            } catch (...) {
+                Ops().Destroy(new_items, new_items + offset);
+                throw;
+            }
+        } catch (...) {
+            Ops().DestroyAt(new_items + offset);
+            throw;
+        }
+        Ops().DestroyTransferred(begin(), end());
+        heap_.swap(buffer);
+        capacity_ = new_capacity;
+        ++size_;
+        VectorEvents<Type>::Reallocation();
+    }
+
+    void Reallocate(size_t new_capacity) {
+        ArrayPtr<Type, Allocator> buffer(new_capacity, uninitialized, heap_.GetAllocator());
+        Ops().UninitializedTransfer(begin(), end(), buffer.GetRawPtr());
+        Ops().DestroyTransferred(begin(), end());
+        heap_.swap(buffer);
+        capacity_ = new_capacity;
+        VectorEvents<Type>::Reallocation();
+    }
+
+    ElementOps<Type, Allocator> Ops() noexcept {
+        return ElementOps<Type, Allocator>(heap_.GetAllocator());
+    }
+
+    size_t NewCapacity(size_t required) const {
+        return GrowthPolicy::NewCapacity(capacity_, required, sizeof(Type));
+    }
+
+private:
+    ArrayPtr<Type, Allocator> heap_;
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    alignas(Type) unsigned char inline_[N * sizeof(Type)];
+};
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline std::compare_three_way_result_t<Type> operator<=>(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                                                         const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return vector_kernels::Compare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator==(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && vector_kernels::Equal(lhs.cbegin(), rhs.cbegin(), lhs.GetSize());
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator!=(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator<(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                      const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) < 0;
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator<=(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) <= 0;
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator>(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                      const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) > 0;
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator>=(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return (lhs <=> rhs) >= 0;
+}
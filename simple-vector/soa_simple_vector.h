@@ -0,0 +1,455 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "array_ptr.h"
+#include "element_ops.h"
+#include "growth_policy.h"
+#include "simple_vector_view.h"
+
+// Proxy for one row of a SoASimpleVector: a reference to each field. Copying a row out
+// converts it to std::tuple; structured bindings bind to the fields themselves.
+template <typename... Fields>
+class SoARow {
+public:
+    explicit SoARow(Fields&... fields) noexcept
+        : fields_(fields...) {
+    }
+
+    template <size_t I>
+    auto& Get() const noexcept {
+        return std::get<I>(fields_);
+    }
+
+    operator std::tuple<std::remove_const_t<Fields>...>() const {
+        return fields_;
+    }
+
+    // Assigns every field; only rows of mutable vectors can be assigned to
+    template <typename Tuple>
+        requires(!(std::is_const_v<Fields> || ...))
+    const SoARow& operator=(Tuple&& values) const {
+        Assign(std::forward<Tuple>(values), std::index_sequence_for<Fields...>{});
+        return *this;
+    }
+
+    SoARow(const SoARow&) noexcept = default;
+
+    const SoARow& operator=(const SoARow& other) const
+        requires(!(std::is_const_v<Fields> || ...)) {
+        Assign(other.fields_, std::index_sequence_for<Fields...>{});
+        return *this;
+    }
+
+    template <size_t I>
+    friend auto& get(const SoARow& row) noexcept {
+        return row.template Get<I>();
+    }
+
+    friend bool operator==(const SoARow& lhs, const std::tuple<std::remove_const_t<Fields>...>& rhs) {
+        return lhs.fields_ == rhs;
+    }
+
+private:
+    template <typename Tuple, size_t... I>
+    void Assign(Tuple&& values, std::index_sequence<I...>) const {
+        ((std::get<I>(fields_) = std::get<I>(std::forward<Tuple>(values))), ...);
+    }
+
+    std::tuple<Fields&...> fields_;
+};
+
+template <typename... Fields>
+struct std::tuple_size<SoARow<Fields...>> : std::integral_constant<size_t, sizeof...(Fields)> {
+};
+
+template <size_t I, typename... Fields>
+struct std::tuple_element<I, SoARow<Fields...>> {
+    using type = std::tuple_element_t<I, std::tuple<Fields...>>&;
+};
+
+// Structure-of-arrays vector: one contiguous column per field, so a loop that reads one
+// field streams through that column only. Rows are added and removed as a whole and
+// capacity is shared by all columns, growing by GrowthPolicy with the row size as the
+// element size. Column<I>() exposes a column as a SimpleVectorView.
+template <typename GrowthPolicy, typename... Types>
+class BasicSoASimpleVector {
+    static_assert(sizeof...(Types) > 0);
+
+    template <size_t I>
+    using Field = std::tuple_element_t<I, std::tuple<Types...>>;
+
+    using Columns = std::tuple<ArrayPtr<Types>...>;
+    using Indices = std::index_sequence_for<Types...>;
+
+    static constexpr size_t kRowBytes = (sizeof(Types) + ...);
+
+    template <typename Type>
+    static constexpr bool kRelocationCopies = !IsTriviallyRelocatable<Type>::value
+                                              && !std::is_nothrow_move_constructible_v<Type>
+                                              && std::is_copy_constructible_v<Type>;
+    static constexpr bool kAnyColumnCopies = (kRelocationCopies<Types> || ...);
+    // a column that can only be moved is lost if a copy of a later column throws
+    static constexpr bool kIntactOnFailure = ((IsTriviallyRelocatable<Types>::value
+                                               || (kAnyColumnCopies ? std::is_copy_constructible_v<Types>
+                                                                    : std::is_nothrow_move_constructible_v<Types>))
+                                              && ...);
+
+public:
+    using Row = SoARow<Types...>;
+    using ConstRow = SoARow<const Types...>;
+    using Tuple = std::tuple<Types...>;
+
+    BasicSoASimpleVector() noexcept = default;
+
+    // size value-initialized rows
+    explicit BasicSoASimpleVector(size_t size) {
+        Resize(size);
+    }
+
+    BasicSoASimpleVector(std::initializer_list<Tuple> rows) {
+        Reserve(rows.size());
+        for (const Tuple& row : rows) {
+            PushBack(row);
+        }
+    }
+
+    BasicSoASimpleVector(const BasicSoASimpleVector& other)
+        : columns_(ArrayPtr<Types>(other.size_, uninitialized)...)
+        , capacity_(other.size_) {
+        CopyColumns(other, Indices{});
+        size_ = other.size_;
+    }
+
+    BasicSoASimpleVector(BasicSoASimpleVector&& other) noexcept
+        : columns_(std::move(other.columns_))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    ~BasicSoASimpleVector() {
+        DestroyRows(0, size_, Indices{});
+    }
+
+    BasicSoASimpleVector& operator=(const BasicSoASimpleVector& other) {
+        if (this != &other) {
+            BasicSoASimpleVector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    BasicSoASimpleVector& operator=(BasicSoASimpleVector&& other) noexcept {
+        if (this != &other) {
+            BasicSoASimpleVector moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    void swap(BasicSoASimpleVector& other) noexcept {
+        SwapColumns(columns_, other.columns_, Indices{});
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    template <size_t I>
+    SimpleVectorView<Field<I>> Column() noexcept {
+        return SimpleVectorView<Field<I>>(Data<I>(), size_);
+    }
+
+    template <size_t I>
+    SimpleVectorView<const Field<I>> Column() const noexcept {
+        return SimpleVectorView<const Field<I>>(Data<I>(), size_);
+    }
+
+    Row operator[](size_t index) noexcept {
+        assert(index < size_);
+        return MakeRow<Row>(*this, index, Indices{});
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return MakeRow<ConstRow>(*this, index, Indices{});
+    }
+
+    Row At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return (*this)[index];
+    }
+
+    ConstRow At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return (*this)[index];
+    }
+
+    void PushBack(const Tuple& row) {
+        std::apply([this](const Types&... fields) {
+            EmplaceBack(fields...);
+        }, row);
+    }
+
+    void PushBack(Tuple&& row) {
+        std::apply([this](Types&... fields) {
+            EmplaceBack(std::move(fields)...);
+        }, row);
+    }
+
+    // Constructs each field of the new row from the matching argument. The arguments may
+    // refer to rows of this vector.
+    template <typename... Args>
+        requires(sizeof...(Args) == sizeof...(Types))
+    Row EmplaceBack(Args&&... args) {
+        if (size_ == capacity_) {
+            ReallocateWithRow(NewCapacity(size_ + 1), std::forward<Args>(args)...);
+        } else {
+            ConstructRow(columns_, size_, Indices{}, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        DestroyRows(size_ - 1, size_, Indices{});
+        --size_;
+        MaybeShrink();
+    }
+
+    // Shifts the following rows down by one in every column
+    void Erase(size_t index) {
+        assert(index < size_);
+        EraseColumns(index, Indices{});
+        DestroyRows(size_ - 1, size_, Indices{});
+        --size_;
+        MaybeShrink();
+    }
+
+    void Clear() noexcept {
+        DestroyRows(0, size_, Indices{});
+        size_ = 0;
+        MaybeShrink();
+    }
+
+    // New rows are value-initialized
+    void Resize(size_t new_size) {
+        if (new_size > capacity_) {
+            Reallocate(NewCapacity(new_size));
+        }
+        if (new_size > size_) {
+            ConstructRows(size_, new_size - size_, Indices{});
+        } else {
+            DestroyRows(new_size, size_, Indices{});
+        }
+        size_ = new_size;
+        MaybeShrink();
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    void ShrinkToFit() {
+        if (capacity_ > size_) {
+            Reallocate(size_);
+        }
+    }
+
+private:
+    template <size_t I>
+    Field<I>* Data() noexcept {
+        return std::get<I>(columns_).GetRawPtr();
+    }
+
+    template <size_t I>
+    const Field<I>* Data() const noexcept {
+        return std::get<I>(columns_).GetRawPtr();
+    }
+
+    template <size_t I>
+    static ElementOps<Field<I>, std::allocator<Field<I>>> Ops(Columns& columns) noexcept {
+        return ElementOps<Field<I>, std::allocator<Field<I>>>(std::get<I>(columns).GetAllocator());
+    }
+
+    template <typename RowType, typename Self, size_t... I>
+    static RowType MakeRow(Self& self, size_t index, std::index_sequence<I...>) noexcept {
+        return RowType(self.template Data<I>()[index]...);
+    }
+
+    size_t NewCapacity(size_t required) const {
+        return GrowthPolicy::NewCapacity(capacity_, required, kRowBytes);
+    }
+
+    void Reallocate(size_t new_capacity) {
+        Columns buffer(ArrayPtr<Types>(new_capacity, uninitialized)...);
+        TransferColumns(buffer, Indices{});
+        Adopt(buffer, new_capacity);
+    }
+
+    // Constructs the new row in the new columns while the old rows are still in place,
+    // so args may refer to them, and only then moves the old rows over
+    template <typename... Args>
+    void ReallocateWithRow(size_t new_capacity, Args&&... args) {
+        Columns buffer(ArrayPtr<Types>(new_capacity, uninitialized)...);
+        ConstructRow(buffer, size_, Indices{}, std::forward<Args>(args)...);
+        try {
+            TransferColumns(buffer, Indices{});
+        } catch (...) {
+            DestroyRow(buffer, size_, Indices{});
+            throw;
+        }
+        Adopt(buffer, new_capacity);
+    }
+
+    void Adopt(Columns& buffer, size_t new_capacity) noexcept {
+        DestroyTransferred(Indices{});
+        SwapColumns(columns_, buffer, Indices{});
+        capacity_ = new_capacity;
+    }
+
+    template <size_t... I>
+    static void SwapColumns(Columns& lhs, Columns& rhs, std::index_sequence<I...>) noexcept {
+        (std::get<I>(lhs).swap(std::get<I>(rhs)), ...);
+    }
+
+    // Runs step(column) for every column index in order; if one throws, undo(column) is
+    // called for the columns already done before rethrowing
+    template <size_t... I, typename Step, typename Undo>
+    static void ForEachColumn(std::index_sequence<I...>, Step&& step, Undo&& undo) {
+        size_t done = 0;
+        try {
+            ((step(std::integral_constant<size_t, I>{}), ++done), ...);
+        } catch (...) {
+            ((I < done ? undo(std::integral_constant<size_t, I>{}) : void()), ...);
+            throw;
+        }
+    }
+
+    template <size_t... I, typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, std::index_sequence<I...> indices, Args&&... args) {
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        ForEachColumn(indices, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            Ops<kColumn>(columns).ConstructAt(std::get<kColumn>(columns).GetRawPtr() + index,
+                                              std::get<kColumn>(std::move(values)));
+        }, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            Ops<kColumn>(columns).DestroyAt(std::get<kColumn>(columns).GetRawPtr() + index);
+        });
+    }
+
+    template <size_t... I>
+    void ConstructRows(size_t first, size_t count, std::index_sequence<I...> indices) {
+        ForEachColumn(indices, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            Ops<kColumn>(columns_).UninitializedConstruct(Data<kColumn>() + first, count);
+        }, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            Ops<kColumn>(columns_).Destroy(Data<kColumn>() + first, Data<kColumn>() + first + count);
+        });
+    }
+
+    template <size_t... I>
+    void DestroyRows(size_t first, size_t last, std::index_sequence<I...>) noexcept {
+        (Ops<I>(columns_).Destroy(Data<I>() + first, Data<I>() + last), ...);
+    }
+
+    // Relocates every column into buffer. Once one column has to be copied, because its
+    // move may throw, the others are copied too: a column moved before a later copy
+    // throws could not be restored. Bytewise columns stay owned by the source until
+    // Adopt, so a failure only destroys the copies.
+    template <size_t... I>
+    void TransferColumns(Columns& buffer, std::index_sequence<I...> indices) {
+        ForEachColumn(indices, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            using Type = Field<kColumn>;
+            Type* dest = std::get<kColumn>(buffer).GetRawPtr();
+            if constexpr (kAnyColumnCopies && !IsTriviallyRelocatable<Type>::value
+                          && std::is_copy_constructible_v<Type>) {
+                Ops<kColumn>(columns_).UninitializedCopy(Data<kColumn>(), Data<kColumn>() + size_, dest);
+                VectorEvents<Type>::Relocation(RelocationKind::kCopy, size_);
+            } else {
+                Ops<kColumn>(columns_).UninitializedTransfer(Data<kColumn>(), Data<kColumn>() + size_, dest);
+            }
+        }, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            if constexpr (!IsTriviallyRelocatable<Field<kColumn>>::value) {
+                Ops<kColumn>(buffer).Destroy(std::get<kColumn>(buffer).GetRawPtr(),
+                                             std::get<kColumn>(buffer).GetRawPtr() + size_);
+            }
+        });
+    }
+
+    template <size_t... I>
+    void DestroyTransferred(std::index_sequence<I...>) noexcept {
+        (Ops<I>(columns_).DestroyTransferred(Data<I>(), Data<I>() + size_), ...);
+    }
+
+    template <size_t... I>
+    static void DestroyRow(Columns& columns, size_t index, std::index_sequence<I...>) noexcept {
+        (Ops<I>(columns).DestroyAt(std::get<I>(columns).GetRawPtr() + index), ...);
+    }
+
+    template <size_t... I>
+    void CopyColumns(const BasicSoASimpleVector& other, std::index_sequence<I...> indices) {
+        ForEachColumn(indices, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            Ops<kColumn>(columns_).UninitializedCopy(other.template Data<kColumn>(),
+                                                     other.template Data<kColumn>() + other.size_, Data<kColumn>());
+        }, [&](auto column) {
+            constexpr size_t kColumn = decltype(column)::value;
+            Ops<kColumn>(columns_).Destroy(Data<kColumn>(), Data<kColumn>() + other.size_);
+        });
+    }
+
+    template <size_t... I>
+    void EraseColumns(size_t index, std::index_sequence<I...>) {
+        (std::move(Data<I>() + index + 1, Data<I>() + size_, Data<I>() + index), ...);
+    }
+
+    // As in SimpleVector: a failed shrink keeps the current buffer, so rows are shrunk
+    // automatically only when a failed TransferColumns leaves every column intact
+    void MaybeShrink() noexcept {
+        if constexpr (kIntactOnFailure && requires { GrowthPolicy::ShrinkCapacity(capacity_, size_); }) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(capacity_, size_);
+            if (new_capacity < capacity_) {
+                try {
+                    Reallocate(new_capacity);
+                } catch (...) {
+                }
+            }
+        }
+    }
+
+    Columns columns_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
+
+template <typename... Types>
+using SoASimpleVector = BasicSoASimpleVector<DoublingGrowth, Types...>;
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "vector_kernels.h"
+
+// SimpleVector interface over inline storage for at most N elements: no allocation, and
+// growing past N throws std::length_error. Everything is constexpr, so tables can be built
+// at compile time, and the vector is trivially copyable and destructible whenever Type is.
+template <typename Type, size_t N>
+class StaticSimpleVector {
+    static constexpr bool kTrivialCopy = std::is_trivially_copyable_v<Type>;
+    static constexpr bool kTrivialDestroy = std::is_trivially_destructible_v<Type>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using value_type = Type;
+
+    constexpr StaticSimpleVector() noexcept {
+        // a constant expression may not leave storage indeterminate, trivial elements are
+        // zeroed during constant evaluation only
+        if constexpr (std::is_trivially_default_constructible_v<Type>) {
+            if (std::is_constant_evaluated()) {
+                for (Type& item : items_) {
+                    std::construct_at(&item);
+                }
+            }
+        }
+    }
+
+    constexpr explicit StaticSimpleVector(size_t size)
+        : StaticSimpleVector() {
+        Resize(size);
+    }
+
+    constexpr StaticSimpleVector(size_t size, const Type& value)
+        : StaticSimpleVector() {
+        CheckCapacity(size);
+        for (; size_ < size; ++size_) {
+            std::construct_at(items_ + size_, value);
+        }
+    }
+
+    constexpr StaticSimpleVector(std::initializer_list<Type> init)
+        : StaticSimpleVector(init.begin(), init.end()) {
+    }
+
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    constexpr StaticSimpleVector(InputIt first, Sentinel last)
+        : StaticSimpleVector() {
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    StaticSimpleVector(const StaticSimpleVector&) requires kTrivialCopy = default;
+
+    constexpr StaticSimpleVector(const StaticSimpleVector& other)
+        : StaticSimpleVector(other.begin(), other.end()) {
+    }
+
+    StaticSimpleVector(StaticSimpleVector&&) requires kTrivialCopy = default;
+
+    // Moves the elements, other keeps its size
+    constexpr StaticSimpleVector(StaticSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>)
+        : StaticSimpleVector(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end())) {
+    }
+
+    ~StaticSimpleVector() requires kTrivialDestroy = default;
+
+    constexpr ~StaticSimpleVector() {
+        Clear();
+    }
+
+    StaticSimpleVector& operator=(const StaticSimpleVector&) requires kTrivialCopy = default;
+
+    constexpr StaticSimpleVector& operator=(const StaticSimpleVector& other) {
+        if (this != &other) {
+            Assign(other.begin(), other.size_);
+        }
+        return *this;
+    }
+
+    StaticSimpleVector& operator=(StaticSimpleVector&&) requires kTrivialCopy = default;
+
+    constexpr StaticSimpleVector& operator=(StaticSimpleVector&& other) noexcept(
+        std::is_nothrow_move_assignable_v<Type> && std::is_nothrow_move_constructible_v<Type>) {
+        if (this != &other) {
+            Assign(std::make_move_iterator(other.begin()), other.size_);
+        }
+        return *this;
+    }
+
+    constexpr void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    constexpr void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    template <typename... Args>
+    constexpr Type& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+        std::construct_at(items_ + size_, std::forward<Args>(args)...);
+        return items_[size_++];
+    }
+
+    constexpr Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    constexpr Iterator Emplace(ConstIterator pos, Args&&... args) {
+        assert(cbegin() <= pos && pos <= cend());
+        const size_t offset = pos - cbegin();
+        CheckCapacity(size_ + 1);
+        if (offset == size_) {
+            EmplaceBack(std::forward<Args>(args)...);
+        } else {
+            // args may refer to elements of this vector, so build the value before shifting
+            Type value(std::forward<Args>(args)...);
+            std::construct_at(end(), std::move(items_[size_ - 1]));
+            ++size_;
+            std::move_backward(begin() + offset, end() - 2, end() - 1);
+            items_[offset] = std::move(value);
+        }
+        return begin() + offset;
+    }
+
+    constexpr void PopBack() noexcept {
+        if (!IsEmpty()) {
+            std::destroy_at(items_ + --size_);
+        }
+    }
+
+    constexpr Iterator Erase(ConstIterator pos) {
+        assert(cbegin() <= pos && pos < cend());
+        return EraseRange(pos, pos + 1);
+    }
+
+    constexpr Iterator EraseRange(ConstIterator first, ConstIterator last) {
+        assert(cbegin() <= first && first <= last && last <= cend());
+        const size_t offset = first - cbegin();
+        Iterator new_end = std::move(begin() + (last - cbegin()), end(), begin() + offset);
+        DestroyFrom(new_end - begin());
+        return begin() + offset;
+    }
+
+    // Removes every element satisfying pred in a single compacting pass, returns the number removed
+    template <typename Predicate>
+    constexpr size_t EraseIf(Predicate pred) {
+        const size_t new_size = std::remove_if(begin(), end(), pred) - begin();
+        const size_t removed = size_ - new_size;
+        DestroyFrom(new_size);
+        return removed;
+    }
+
+    constexpr void swap(StaticSimpleVector& other) noexcept(std::is_nothrow_swappable_v<Type>
+                                                            && std::is_nothrow_move_constructible_v<Type>) {
+        StaticSimpleVector& shorter = size_ < other.size_ ? *this : other;
+        StaticSimpleVector& longer = size_ < other.size_ ? other : *this;
+        const size_t common = shorter.size_;
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        for (size_t i = common; i < longer.size_; ++i) {
+            std::construct_at(shorter.items_ + i, std::move(longer.items_[i]));
+        }
+        shorter.size_ = longer.size_;
+        longer.DestroyFrom(common);
+    }
+
+    constexpr size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t GetCapacity() noexcept {
+        return N;
+    }
+
+    constexpr bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr bool IsFull() const noexcept {
+        return size_ == N;
+    }
+
+    constexpr Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return items_[index];
+    }
+
+    constexpr const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return items_[index];
+    }
+
+    constexpr Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return items_[index];
+    }
+
+    constexpr const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Index out of range");
+        }
+        return items_[index];
+    }
+
+    constexpr void Clear() noexcept {
+        DestroyFrom(0);
+    }
+
+    // New elements are value-initialized
+    constexpr void Resize(size_t new_size) {
+        CheckCapacity(new_size);
+        if (new_size < size_) {
+            DestroyFrom(new_size);
+        }
+        for (; size_ < new_size; ++size_) {
+            std::construct_at(items_ + size_);
+        }
+    }
+
+    // Only checks that new_capacity fits
+    constexpr void Reserve(size_t new_capacity) const {
+        CheckCapacity(new_capacity);
+    }
+
+    constexpr Iterator begin() noexcept {
+        return items_;
+    }
+
+    constexpr Iterator end() noexcept {
+        return items_ + size_;
+    }
+
+    constexpr ConstIterator begin() const noexcept {
+        return items_;
+    }
+
+    constexpr ConstIterator end() const noexcept {
+        return items_ + size_;
+    }
+
+    constexpr ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    constexpr ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    static constexpr void CheckCapacity(size_t size) {
+        if (size > N) {
+            throw std::length_error("StaticSimpleVector capacity exceeded");
+        }
+    }
+
+    template <typename InputIt>
+    constexpr void Assign(InputIt first, size_t count) {
+        const size_t common = std::min(size_, count);
+        for (size_t i = 0; i < common; ++i, ++first) {
+            items_[i] = *first;
+        }
+        for (; size_ < count; ++size_, ++first) {
+            std::construct_at(items_ + size_, *first);
+        }
+        DestroyFrom(count);
+    }
+
+    constexpr void DestroyFrom(size_t new_size) noexcept {
+        if constexpr (!kTrivialDestroy) {
+            while (size_ > new_size) {
+                std::destroy_at(items_ + --size_);
+            }
+        }
+        size_ = std::min(size_, new_size);
+    }
+
+    // Elements live in a union so that none is constructed until it is added
+    union {
+        Type items_[N];
+    };
+    size_t size_ = 0;
+};
+
+template <typename Type, size_t N>
+constexpr std::compare_three_way_result_t<Type> operator<=>(const StaticSimpleVector<Type, N>& lhs,
+                                                            const StaticSimpleVector<Type, N>& rhs) {
+    if (std::is_constant_evaluated()) {
+        return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+    return vector_kernels::Compare(lhs.cbegin(), lhs.GetSize(), rhs.cbegin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N>
+constexpr bool operator==(const StaticSimpleVector<Type, N>& lhs, const StaticSimpleVector<Type, N>& rhs) {
+    if (lhs.GetSize() != rhs.GetSize()) {
+        return false;
+    }
+    if (std::is_constant_evaluated()) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+    return vector_kernels::Equal(lhs.cbegin(), rhs.cbegin(), lhs.GetSize());
+}
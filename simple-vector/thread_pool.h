@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. Workers pop their own deque from
+// the back and steal from the front of the others when it runs dry. Threads waiting in
+// ParallelFor run queued tasks too, so nested parallel calls cannot deadlock.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = std::max(std::thread::hardware_concurrency(), 1u))
+        : queues_(std::max<size_t>(threads, 1)) {
+        for (auto& queue : queues_) {
+            queue = std::make_unique<Queue>();
+        }
+        workers_.reserve(queues_.size());
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            workers_.emplace_back([this, i] {
+                Run(i);
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard guard(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const noexcept {
+        return workers_.size();
+    }
+
+    // Queues task without waiting for it; task must not throw.
+    // Tasks submitted from a worker go to its own deque.
+    void Submit(std::function<void()> task) {
+        size_t index = CurrentWorker();
+        if (index == kNotAWorker) {
+            index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        }
+        {
+            std::lock_guard guard(sleep_mutex_);
+            ++pending_;
+        }
+        try {
+            std::lock_guard guard(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        } catch (...) {
+            std::lock_guard guard(sleep_mutex_);
+            --pending_;
+            throw;
+        }
+        sleep_cv_.notify_one();
+    }
+
+    // Runs body(0) .. body(count - 1) across the pool and the calling thread and waits for
+    // all of them. The first exception thrown by body is rethrown once every call finished.
+    template <typename Body>
+    void ParallelFor(size_t count, Body&& body) {
+        if (count <= 1) {
+            if (count == 1) {
+                body(size_t{0});
+            }
+            return;
+        }
+
+        std::atomic<size_t> remaining{count};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        auto run = [&](size_t index) noexcept {
+            try {
+                body(index);
+            } catch (...) {
+                std::lock_guard guard(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        };
+
+        size_t submitted = 1;
+        try {
+            for (; submitted < count; ++submitted) {
+                Submit([&run, submitted] {
+                    run(submitted);
+                });
+            }
+        } catch (...) {
+            // queued tasks still refer to this frame, so finish the rest here instead
+            for (size_t i = submitted; i < count; ++i) {
+                run(i);
+            }
+        }
+        run(0);
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!TryRunOne(CurrentWorker())) {
+                std::this_thread::yield();
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    static constexpr size_t kNotAWorker = static_cast<size_t>(-1);
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    size_t CurrentWorker() const noexcept {
+        return current_pool_ == this ? current_index_ : kNotAWorker;
+    }
+
+    void Run(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            if (TryRunOne(index)) {
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex_);
+            if (stop_ && pending_ == 0) {
+                return;
+            }
+            sleep_cv_.wait(lock, [this] {
+                return stop_ || pending_ > 0;
+            });
+        }
+    }
+
+    // Runs one task from the own deque of worker index, or steals one from another worker
+    bool TryRunOne(size_t index) {
+        std::function<void()> task;
+        if (index != kNotAWorker) {
+            std::lock_guard guard(queues_[index]->mutex);
+            if (!queues_[index]->tasks.empty()) {
+                task = std::move(queues_[index]->tasks.back());
+                queues_[index]->tasks.pop_back();
+            }
+        }
+        const size_t start = index == kNotAWorker ? 0 : index + 1;
+        for (size_t i = 0; !task && i < queues_.size(); ++i) {
+            Queue& victim = *queues_[(start + i) % queues_.size()];
+            std::lock_guard guard(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) {
+            return false;
+        }
+        {
+            std::lock_guard guard(sleep_mutex_);
+            --pending_;
+        }
+        task();
+        return true;
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    size_t pending_ = 0;
+    bool stop_ = false;
+
+    static inline thread_local const ThreadPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+};
+
+// Shared pool with one thread per hardware thread, started on first use
+inline ThreadPool& DefaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
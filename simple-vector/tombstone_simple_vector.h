@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "simple_bit_vector.h"
+#include "simple_vector.h"
+
+// SimpleVector whose Erase only marks the slot dead in a bit vector, keeping the indices
+// of all other elements stable. Dead slots keep their objects until Compact() removes
+// them all in one order-preserving pass, or CompactIfSparse() decides it is worth it.
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DoublingGrowth>
+class TombstoneSimpleVector {
+    using Vector = SimpleVector<Type, Allocator, GrowthPolicy>;
+    // the dead bits come from the same allocator as the elements
+    using BitAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<bit_kernels::Word>;
+
+public:
+    TombstoneSimpleVector() noexcept = default;
+
+    explicit TombstoneSimpleVector(const Allocator& alloc) noexcept
+        : items_(alloc)
+        , dead_(BitAllocator(alloc)) {
+    }
+
+    // Number of slots, dead ones included; indices below it are valid
+    size_t GetSize() const noexcept {
+        return items_.GetSize();
+    }
+
+    size_t GetLiveCount() const noexcept {
+        return items_.GetSize() - dead_count_;
+    }
+
+    size_t GetDeadCount() const noexcept {
+        return dead_count_;
+    }
+
+    bool IsErased(size_t index) const noexcept {
+        return dead_[index];
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(!IsErased(index));
+        return items_[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(!IsErased(index));
+        return items_[index];
+    }
+
+    // Throws for dead slots as well as for indices past the end
+    Type& At(size_t index) {
+        CheckLive(index);
+        return items_[index];
+    }
+
+    const Type& At(size_t index) const {
+        CheckLive(index);
+        return items_[index];
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Returns the index of the new element
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args) {
+        dead_.PushBack(false);
+        try {
+            items_.EmplaceBack(std::forward<Args>(args)...);
+        } catch (...) {
+            dead_.PopBack();
+            throw;
+        }
+        return items_.GetSize() - 1;
+    }
+
+    // O(1): marks the slot dead, the element stays in place until Compact
+    void Erase(size_t index) noexcept {
+        assert(index < GetSize() && !IsErased(index));
+        dead_.Set(index);
+        ++dead_count_;
+    }
+
+    // Removes the dead slots, moving every live element down once. Indices change.
+    // Returns the number of slots removed.
+    size_t Compact() {
+        static_assert(std::is_nothrow_move_assignable_v<Type>, "a throwing move would leave slots half compacted");
+        if (dead_count_ == 0) {
+            return 0;
+        }
+        size_t write = dead_.FindFirst();
+        for (size_t read = write + 1; read < items_.GetSize(); ++read) {
+            if (!dead_[read]) {
+                items_[write++] = std::move(items_[read]);
+            }
+        }
+        items_.EraseRange(items_.cbegin() + write, items_.cend());
+        dead_.Clear();
+        dead_.Resize(write);
+        return std::exchange(dead_count_, 0);
+    }
+
+    // Compacts once dead slots make up more than max_dead_share of the vector
+    bool CompactIfSparse(double max_dead_share = 0.5) {
+        if (dead_count_ > max_dead_share * items_.GetSize()) {
+            Compact();
+            return true;
+        }
+        return false;
+    }
+
+    // Calls f(index, element) for every live element in index order
+    template <typename Function>
+    void ForEachLive(Function f) {
+        for (size_t index = 0; index < items_.GetSize(); ++index) {
+            if (!dead_[index]) {
+                f(index, items_[index]);
+            }
+        }
+    }
+
+    template <typename Function>
+    void ForEachLive(Function f) const {
+        for (size_t index = 0; index < items_.GetSize(); ++index) {
+            if (!dead_[index]) {
+                f(index, items_[index]);
+            }
+        }
+    }
+
+    void Clear() noexcept {
+        items_.Clear();
+        dead_.Clear();
+        dead_count_ = 0;
+    }
+
+    void Reserve(size_t new_capacity) {
+        items_.Reserve(new_capacity);
+        dead_.Reserve(new_capacity);
+    }
+
+    // The slots, dead ones included; only meaningful after Compact() or with IsErased
+    const Vector& GetItems() const noexcept {
+        return items_;
+    }
+
+private:
+    void CheckLive(size_t index) const {
+        if (index >= GetSize() || IsErased(index)) {
+            throw std::out_of_range("Index out of range");
+        }
+    }
+
+    Vector items_;
+    SimpleBitVector<BitAllocator> dead_;
+    size_t dead_count_ = 0;
+};
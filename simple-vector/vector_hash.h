@@ -0,0 +1,162 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+#include "vector_kernels.h"
+
+// Hashing of whole vectors. Buffers of IsBytewiseComparable elements are hashed as bytes,
+// 48 at a time with three independent 64x64->128 multiply lanes (the wyhash construction);
+// equal vectors have equal bytes, so this agrees with operator==. Other elements are
+// hashed one by one with std::hash and combined. Results are not stable across versions
+// and must not be stored.
+namespace vector_hash {
+
+inline constexpr uint64_t kDefaultSeed = 0x9e3779b97f4a7c15ull;
+
+template <typename Type>
+inline constexpr bool kBytewiseHashable = IsBytewiseComparable<Type>::value;
+
+template <typename Type>
+concept Hashable = kBytewiseHashable<Type> || requires(const Type& value) {
+    { std::hash<Type>()(value) } -> std::convertible_to<size_t>;
+};
+
+namespace detail {
+
+inline constexpr uint64_t kSecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+                                        0x589965cc75374cc3ull};
+
+#if defined(__SIZEOF_INT128__)
+__extension__ using UInt128 = unsigned __int128;
+#endif
+
+// Folds the 128-bit product of a and b to 64 bits
+inline uint64_t Mix(uint64_t a, uint64_t b) noexcept {
+#if defined(__SIZEOF_INT128__)
+    const UInt128 product = static_cast<UInt128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32, b_lo = b & 0xffffffff, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+    const uint64_t lo = (cross << 32) | (lo_lo & 0xffffffff);
+    const uint64_t hi = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return lo ^ hi;
+#endif
+}
+
+inline uint64_t Read8(const unsigned char* bytes) noexcept {
+    uint64_t word;
+    std::memcpy(&word, bytes, 8);
+    return word;
+}
+
+inline uint64_t Read4(const unsigned char* bytes) noexcept {
+    uint32_t word;
+    std::memcpy(&word, bytes, 4);
+    return word;
+}
+
+}  // namespace detail
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = kDefaultSeed) noexcept {
+    using detail::kSecret;
+    using detail::Mix;
+    using detail::Read4;
+    using detail::Read8;
+
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    seed ^= Mix(seed ^ kSecret[0], kSecret[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16) {
+        if (size >= 4) {
+            // two possibly overlapping 8-byte windows built from 4-byte reads
+            const size_t step = (size >> 3) << 2;
+            a = (Read4(bytes) << 32) | Read4(bytes + step);
+            b = (Read4(bytes + size - 4) << 32) | Read4(bytes + size - 4 - step);
+        } else if (size > 0) {
+            a = (uint64_t{bytes[0]} << 16) | (uint64_t{bytes[size >> 1]} << 8) | bytes[size - 1];
+        }
+    } else {
+        size_t left = size;
+        if (left > 48) {
+            uint64_t lane1 = seed;
+            uint64_t lane2 = seed;
+            do {
+                seed = Mix(Read8(bytes) ^ kSecret[1], Read8(bytes + 8) ^ seed);
+                lane1 = Mix(Read8(bytes + 16) ^ kSecret[2], Read8(bytes + 24) ^ lane1);
+                lane2 = Mix(Read8(bytes + 32) ^ kSecret[3], Read8(bytes + 40) ^ lane2);
+                bytes += 48;
+                left -= 48;
+            } while (left > 48);
+            seed ^= lane1 ^ lane2;
+        }
+        for (; left > 16; bytes += 16, left -= 16) {
+            seed = Mix(Read8(bytes) ^ kSecret[1], Read8(bytes + 8) ^ seed);
+        }
+        // the last 16 bytes, overlapping what was already mixed
+        a = Read8(bytes + left - 16);
+        b = Read8(bytes + left - 8);
+    }
+    a ^= kSecret[1];
+    b ^= seed;
+#if defined(__SIZEOF_INT128__)
+    const detail::UInt128 product = static_cast<detail::UInt128>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#else
+    const uint64_t folded = Mix(a, b);
+    a ^= folded;
+    b ^= folded;
+#endif
+    return Mix(a ^ kSecret[0] ^ size, b ^ kSecret[1]);
+}
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) noexcept {
+    return detail::Mix(seed ^ value, detail::kSecret[0]) ^ value;
+}
+
+// 64-bit hash of data[0, size) whatever the width of size_t
+template <Hashable Type>
+uint64_t Hash(const Type* data, size_t size, uint64_t seed = kDefaultSeed) noexcept(kBytewiseHashable<Type>) {
+    if constexpr (kBytewiseHashable<Type>) {
+        return HashBytes(data, size * sizeof(Type), seed);
+    } else {
+        uint64_t hash = HashCombine(seed, size);
+        std::hash<Type> hasher;
+        for (size_t i = 0; i < size; ++i) {
+            hash = HashCombine(hash, hasher(data[i]));
+        }
+        return HashBytes(&hash, sizeof(hash), seed);
+    }
+}
+
+}  // namespace vector_hash
+
+namespace std {
+
+template <typename Type>
+    requires vector_hash::Hashable<remove_const_t<Type>>
+struct hash<SimpleVectorView<Type>> {
+    size_t operator()(SimpleVectorView<Type> view) const noexcept(vector_hash::kBytewiseHashable<remove_const_t<Type>>) {
+        return static_cast<size_t>(vector_hash::Hash<remove_const_t<Type>>(view.Data(), view.GetSize()));
+    }
+};
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+    requires vector_hash::Hashable<Type>
+struct hash<SimpleVector<Type, Allocator, GrowthPolicy>> {
+    size_t operator()(const SimpleVector<Type, Allocator, GrowthPolicy>& items) const
+        noexcept(vector_hash::kBytewiseHashable<Type>) {
+        return static_cast<size_t>(vector_hash::Hash(items.cbegin(), items.GetSize()));
+    }
+};
+
+}  // namespace std
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <numeric>
+#include <ranges>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMPLE_VECTOR_SIMD_X86 1
+#elif defined(__GNUC__) && defined(__ARM_NEON)
+#define SIMPLE_VECTOR_SIMD_NEON 1
+#endif
+
+// Types whose equality is exactly equality of their object representation, so they
+// may be compared with memcmp. Specialize for trivially comparable user types.
+template <typename Type>
+struct IsBytewiseComparable
+    : std::bool_constant<std::is_integral_v<Type> || std::is_enum_v<Type> || std::is_pointer_v<Type>> {
+};
+
+// Comparison and search kernels over contiguous buffers. Arithmetic element types use
+// AVX2 (chosen at runtime) or NEON; everything else falls back to the std algorithms.
+// With NaNs present Min, Max and Sum are unspecified, and floating-point sums are
+// accumulated in a different order than a sequential loop.
+namespace vector_kernels {
+
+namespace detail {
+
+template <typename Type>
+inline constexpr bool kSimdElement = std::is_arithmetic_v<Type> && !std::is_same_v<Type, bool>
+                                     && !std::is_same_v<Type, long double> && sizeof(Type) <= 8;
+
+#if defined(SIMPLE_VECTOR_SIMD_X86)
+
+#define SIMPLE_VECTOR_SIMD_TARGET [[gnu::target("avx2")]]
+
+inline constexpr size_t kVectorBytes = 32;
+
+inline bool HasSimd() noexcept {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+template <typename Mask>
+SIMPLE_VECTOR_SIMD_TARGET inline unsigned ByteMask(Mask mask) noexcept {
+    return static_cast<unsigned>(_mm256_movemask_epi8(reinterpret_cast<__m256i>(mask)));
+}
+
+#elif defined(SIMPLE_VECTOR_SIMD_NEON)
+
+#define SIMPLE_VECTOR_SIMD_TARGET
+
+inline constexpr size_t kVectorBytes = 16;
+
+inline bool HasSimd() noexcept {
+    return true;
+}
+
+template <typename Mask>
+inline unsigned ByteMask(Mask mask) noexcept {
+    unsigned char bytes[kVectorBytes];
+    std::memcpy(bytes, &mask, kVectorBytes);
+    unsigned result = 0;
+    for (size_t i = 0; i < kVectorBytes; ++i) {
+        result |= static_cast<unsigned>(bytes[i] >> 7) << i;
+    }
+    return result;
+}
+
+#endif
+
+#if defined(SIMPLE_VECTOR_SIMD_X86) || defined(SIMPLE_VECTOR_SIMD_NEON)
+
+inline constexpr bool kHasSimdKernels = true;
+
+template <typename Type>
+struct Simd {
+    typedef Type Vec __attribute__((vector_size(kVectorBytes), aligned(alignof(Type))));
+    static constexpr size_t kLanes = kVectorBytes / sizeof(Type);
+
+    SIMPLE_VECTOR_SIMD_TARGET static Vec Load(const Type* data) noexcept {
+        Vec result;
+        std::memcpy(&result, data, kVectorBytes);
+        return result;
+    }
+
+    SIMPLE_VECTOR_SIMD_TARGET static size_t Mismatch(const Type* lhs, const Type* rhs, size_t count) noexcept {
+        size_t i = 0;
+        for (; i + kLanes <= count; i += kLanes) {
+            const unsigned mask = ByteMask(Load(lhs + i) != Load(rhs + i));
+            if (mask != 0) {
+                return i + std::countr_zero(mask) / sizeof(Type);
+            }
+        }
+        for (; i < count; ++i) {
+            if (!(lhs[i] == rhs[i])) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    SIMPLE_VECTOR_SIMD_TARGET static size_t Find(const Type* data, size_t count, Type value) noexcept {
+        const Vec needle = Vec{} + value;
+        size_t i = 0;
+        for (; i + kLanes <= count; i += kLanes) {
+            const unsigned mask = ByteMask(Load(data + i) == needle);
+            if (mask != 0) {
+                return i + std::countr_zero(mask) / sizeof(Type);
+            }
+        }
+        for (; i < count; ++i) {
+            if (data[i] == value) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    SIMPLE_VECTOR_SIMD_TARGET static size_t Count(const Type* data, size_t count, Type value) noexcept {
+        const Vec needle = Vec{} + value;
+        size_t result = 0;
+        size_t i = 0;
+        for (; i + kLanes <= count; i += kLanes) {
+            result += std::popcount(ByteMask(Load(data + i) == needle)) / sizeof(Type);
+        }
+        for (; i < count; ++i) {
+            result += data[i] == value;
+        }
+        return result;
+    }
+
+    // count must be at least kLanes
+    template <bool IsMin>
+    SIMPLE_VECTOR_SIMD_TARGET static Type MinMax(const Type* data, size_t count) noexcept {
+        Vec acc = Load(data);
+        size_t i = kLanes;
+        for (; i + kLanes <= count; i += kLanes) {
+            const Vec v = Load(data + i);
+            if constexpr (IsMin) {
+                acc = v < acc ? v : acc;
+            } else {
+                acc = v > acc ? v : acc;
+            }
+        }
+        Type result = acc[0];
+        for (size_t lane = 1; lane < kLanes; ++lane) {
+            result = IsMin ? std::min(result, static_cast<Type>(acc[lane])) : std::max(result, static_cast<Type>(acc[lane]));
+        }
+        for (; i < count; ++i) {
+            result = IsMin ? std::min(result, data[i]) : std::max(result, data[i]);
+        }
+        return result;
+    }
+
+    SIMPLE_VECTOR_SIMD_TARGET static Type Sum(const Type* data, size_t count) noexcept {
+        Vec acc = Vec{};
+        size_t i = 0;
+        for (; i + kLanes <= count; i += kLanes) {
+            acc += Load(data + i);
+        }
+        Type result = Type{};
+        for (size_t lane = 0; lane < kLanes; ++lane) {
+            result += acc[lane];
+        }
+        for (; i < count; ++i) {
+            result += data[i];
+        }
+        return result;
+    }
+};
+
+#else
+
+inline constexpr bool kHasSimdKernels = false;
+
+inline bool HasSimd() noexcept {
+    return false;
+}
+
+#endif
+
+template <typename Type>
+bool UseSimd(size_t count) noexcept {
+    if constexpr (kHasSimdKernels && kSimdElement<Type>) {
+        return count >= Simd<Type>::kLanes && HasSimd();
+    } else {
+        return false;
+    }
+}
+
+}  // namespace detail
+
+// Index of the first position where the buffers differ, or count if they are equal
+template <typename Type>
+size_t Mismatch(const Type* lhs, const Type* rhs, size_t count) {
+    if constexpr (detail::kHasSimdKernels && detail::kSimdElement<Type>) {
+        if (detail::UseSimd<Type>(count)) {
+            return detail::Simd<Type>::Mismatch(lhs, rhs, count);
+        }
+    }
+    return std::mismatch(lhs, lhs + count, rhs).first - lhs;
+}
+
+template <typename Type>
+bool Equal(const Type* lhs, const Type* rhs, size_t count) {
+    if constexpr (IsBytewiseComparable<Type>::value) {
+        return count == 0 || std::memcmp(lhs, rhs, count * sizeof(Type)) == 0;
+    } else if constexpr (detail::kSimdElement<Type>) {
+        return Mismatch(lhs, rhs, count) == count;
+    } else {
+        return std::equal(lhs, lhs + count, rhs);
+    }
+}
+
+// Lexicographical three-way comparison
+template <typename Type>
+std::compare_three_way_result_t<Type> Compare(const Type* lhs, size_t lhs_size, const Type* rhs, size_t rhs_size) {
+    const size_t common = std::min(lhs_size, rhs_size);
+    if constexpr (sizeof(Type) == 1 && std::is_unsigned_v<Type> && IsBytewiseComparable<Type>::value) {
+        // memcmp orders by unsigned bytes, which is exactly the element order here
+        const int result = common == 0 ? 0 : std::memcmp(lhs, rhs, common);
+        if (result != 0) {
+            return result <=> 0;
+        }
+        return lhs_size <=> rhs_size;
+    } else if constexpr (detail::kSimdElement<Type>) {
+        const size_t index = Mismatch(lhs, rhs, common);
+        if (index != common) {
+            return lhs[index] <=> rhs[index];
+        }
+        return lhs_size <=> rhs_size;
+    } else {
+        return std::lexicographical_compare_three_way(lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+    }
+}
+
+// Index of the first element equal to value, or count if there is none
+template <typename Type>
+size_t Find(const Type* data, size_t count, const Type& value) {
+    if constexpr (detail::kHasSimdKernels && detail::kSimdElement<Type>) {
+        if (detail::UseSimd<Type>(count)) {
+            return detail::Simd<Type>::Find(data, count, value);
+        }
+    }
+    return std::find(data, data + count, value) - data;
+}
+
+template <typename Type>
+size_t Count(const Type* data, size_t count, const Type& value) {
+    if constexpr (detail::kHasSimdKernels && detail::kSimdElement<Type>) {
+        if (detail::UseSimd<Type>(count)) {
+            return detail::Simd<Type>::Count(data, count, value);
+        }
+    }
+    return std::count(data, data + count, value);
+}
+
+// count must be positive
+template <typename Type>
+Type Min(const Type* data, size_t count) {
+    if constexpr (detail::kHasSimdKernels && detail::kSimdElement<Type>) {
+        if (detail::UseSimd<Type>(count)) {
+            return detail::Simd<Type>::template MinMax<true>(data, count);
+        }
+    }
+    return *std::min_element(data, data + count);
+}
+
+// count must be positive
+template <typename Type>
+Type Max(const Type* data, size_t count) {
+    if constexpr (detail::kHasSimdKernels && detail::kSimdElement<Type>) {
+        if (detail::UseSimd<Type>(count)) {
+            return detail::Simd<Type>::template MinMax<false>(data, count);
+        }
+    }
+    return *std::max_element(data, data + count);
+}
+
+template <typename Type>
+Type Sum(const Type* data, size_t count) {
+    if constexpr (detail::kHasSimdKernels && detail::kSimdElement<Type>) {
+        if (detail::UseSimd<Type>(count)) {
+            return detail::Simd<Type>::Sum(data, count);
+        }
+    }
+    return std::accumulate(data, data + count, Type{});
+}
+
+// Overloads for any contiguous container, e.g. SimpleVector or std::vector
+
+template <std::ranges::contiguous_range Range>
+size_t Find(const Range& range, const std::ranges::range_value_t<Range>& value) {
+    return Find(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+template <std::ranges::contiguous_range Range>
+size_t Count(const Range& range, const std::ranges::range_value_t<Range>& value) {
+    return Count(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+template <std::ranges::contiguous_range Range>
+auto Min(const Range& range) {
+    return Min(std::ranges::data(range), std::ranges::size(range));
+}
+
+template <std::ranges::contiguous_range Range>
+auto Max(const Range& range) {
+    return Max(std::ranges::data(range), std::ranges::size(range));
+}
+
+template <std::ranges::contiguous_range Range>
+auto Sum(const Range& range) {
+    return Sum(std::ranges::data(range), std::ranges::size(range));
+}
+
+}  // namespace vector_kernels
@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <variant>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mapped_simple_vector.h"
+#include "simple_vector_view.h"
+
+// Reads a stream of raw Type records, as written by VectorWriter, straight into the unused
+// capacity of a SimpleVector: no intermediate buffer and no per-element work. The source
+// may deliver any number of bytes per read (pipes, sockets); a record split across reads
+// is held back until its remaining bytes arrive.
+template <typename Type>
+class VectorReader {
+    static_assert(std::is_trivially_copyable_v<Type>, "records are read as raw bytes");
+
+public:
+    static constexpr size_t kDefaultChunkBytes = size_t{1} << 20;
+
+    // fd stays owned by the caller
+    explicit VectorReader(int fd, size_t chunk_bytes = kDefaultChunkBytes) noexcept
+        : source_(fd)
+        , chunk_count_(ChunkCount(chunk_bytes)) {
+    }
+
+    explicit VectorReader(std::istream& input, size_t chunk_bytes = kDefaultChunkBytes) noexcept
+        : source_(&input)
+        , chunk_count_(ChunkCount(chunk_bytes)) {
+    }
+
+    // True once the source reported end of stream
+    bool AtEnd() const noexcept {
+        return at_end_;
+    }
+
+    // Bytes of an incomplete record read so far
+    size_t GetPendingBytes() const noexcept {
+        return pending_bytes_;
+    }
+
+    // One read into the capacity past items.end(), which is first grown by at least a chunk
+    // (rounded by the vector's policy) if there is none left. Returns the number of records
+    // appended, which is 0 at end of stream and when a non-blocking fd has nothing to read.
+    template <typename Allocator, typename GrowthPolicy>
+    size_t ReadSome(SimpleVector<Type, Allocator, GrowthPolicy>& items) {
+        if (at_end_) {
+            return 0;
+        }
+        const size_t old_size = items.GetSize();
+        const size_t free_count = items.GetCapacity() - old_size;
+        auto* dest = reinterpret_cast<char*>(items.AppendUninitialized(free_count > 0 ? free_count : chunk_count_));
+        const size_t space = (items.GetSize() - old_size) * sizeof(Type);
+        size_t bytes = pending_bytes_;
+        try {
+            std::memcpy(dest, pending_, pending_bytes_);
+            bytes += ReadBytes(dest + pending_bytes_, space - pending_bytes_);
+        } catch (...) {
+            items.TruncateUninitialized(old_size);
+            throw;
+        }
+        const size_t records = bytes / sizeof(Type);
+        pending_bytes_ = bytes % sizeof(Type);
+        std::memcpy(pending_, dest + records * sizeof(Type), pending_bytes_);
+        // a short read must not make an AutoShrink vector give back the spare capacity
+        // the next read fills
+        items.TruncateUninitialized(old_size + records);
+        return records;
+    }
+
+    // Reads to the end of the stream, returns the number of records appended. Throws
+    // VectorFormatError if the stream ends inside a record.
+    template <typename Allocator, typename GrowthPolicy>
+    size_t ReadAll(SimpleVector<Type, Allocator, GrowthPolicy>& items) {
+        size_t records = 0;
+        while (!at_end_) {
+            records += ReadSome(items);
+        }
+        if (pending_bytes_ != 0) {
+            throw VectorFormatError("Stream ended inside a record");
+        }
+        return records;
+    }
+
+private:
+    static size_t ChunkCount(size_t chunk_bytes) noexcept {
+        return std::max<size_t>(chunk_bytes / sizeof(Type), 1);
+    }
+
+    size_t ReadBytes(char* dest, size_t bytes) {
+        if (const int* fd = std::get_if<int>(&source_)) {
+            while (true) {
+                const ssize_t done = ::read(*fd, dest, bytes);
+                if (done > 0) {
+                    return done;
+                }
+                if (done == 0) {
+                    at_end_ = true;
+                    return 0;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    return 0;
+                }
+                if (errno != EINTR) {
+                    throw std::system_error(errno, std::generic_category(), "read");
+                }
+            }
+        }
+        std::istream& input = *std::get<std::istream*>(source_);
+        input.read(dest, bytes);
+        if (input.eof()) {
+            at_end_ = true;
+        } else if (!input) {
+            throw std::runtime_error("Failed to read vector stream");
+        }
+        return input.gcount();
+    }
+
+    std::variant<int, std::istream*> source_;
+    size_t chunk_count_;
+    bool at_end_ = false;
+    size_t pending_bytes_ = 0;
+    char pending_[sizeof(Type)];
+};
+
+// Writes raw Type records, the format VectorReader reads. Ranges go out in chunks of
+// chunk_bytes straight from their storage; WriteBatch hands several ranges to one
+// writev call.
+template <typename Type>
+class VectorWriter {
+    static_assert(std::is_trivially_copyable_v<Type>, "records are written as raw bytes");
+
+public:
+    static constexpr size_t kDefaultChunkBytes = size_t{1} << 20;
+
+    // fd stays owned by the caller
+    explicit VectorWriter(int fd, size_t chunk_bytes = kDefaultChunkBytes) noexcept
+        : sink_(fd)
+        , chunk_bytes_(std::max(chunk_bytes, sizeof(Type))) {
+    }
+
+    explicit VectorWriter(std::ostream& output, size_t chunk_bytes = kDefaultChunkBytes) noexcept
+        : sink_(&output)
+        , chunk_bytes_(std::max(chunk_bytes, sizeof(Type))) {
+    }
+
+    void Write(SimpleVectorView<const Type> records) {
+        const auto* bytes = reinterpret_cast<const char*>(records.Data());
+        for (size_t left = records.GetSize() * sizeof(Type); left > 0;) {
+            const size_t chunk = std::min(left, chunk_bytes_);
+            WriteBytes(bytes, chunk);
+            bytes += chunk;
+            left -= chunk;
+        }
+    }
+
+    // Writes the ranges back to back; on an fd with one writev per IOV_MAX ranges
+    void WriteBatch(std::initializer_list<SimpleVectorView<const Type>> batch) {
+        const int* fd = std::get_if<int>(&sink_);
+        if (fd == nullptr) {
+            for (SimpleVectorView<const Type> records : batch) {
+                Write(records);
+            }
+            return;
+        }
+        iovec vectors[IOV_MAX];
+        const SimpleVectorView<const Type>* next = batch.begin();
+        while (next != batch.end()) {
+            size_t count = 0;
+            for (; next != batch.end() && count < IOV_MAX; ++next, ++count) {
+                vectors[count].iov_base = const_cast<Type*>(next->Data());
+                vectors[count].iov_len = next->GetSize() * sizeof(Type);
+            }
+            WriteVectors(*fd, vectors, count);
+        }
+    }
+
+private:
+    void WriteBytes(const char* bytes, size_t count) {
+        if (const int* fd = std::get_if<int>(&sink_)) {
+            vector_file::WriteAll(*fd, bytes, count);
+        } else if (!std::get<std::ostream*>(sink_)->write(bytes, count)) {
+            throw std::runtime_error("Failed to write vector stream");
+        }
+    }
+
+    // writev may stop anywhere, even inside a vector; resume from there
+    static void WriteVectors(int fd, iovec* vectors, size_t count) {
+        while (count > 0) {
+            const ssize_t written = ::writev(fd, vectors, static_cast<int>(count));
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "writev");
+            }
+            size_t done = written;
+            while (count > 0 && done >= vectors->iov_len) {
+                done -= vectors->iov_len;
+                ++vectors;
+                --count;
+            }
+            if (count > 0) {
+                vectors->iov_base = static_cast<char*>(vectors->iov_base) + done;
+                vectors->iov_len -= done;
+            }
+        }
+    }
+
+    std::variant<int, std::ostream*> sink_;
+    size_t chunk_bytes_;
+};